@@ -0,0 +1,413 @@
+#include "binary_base.h"
+
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+    constexpr std::string_view MAGIC = "TCDB"sv;
+
+    // smallest encodings, used to reject counts that could not fit in what is left
+    constexpr size_t MIN_STOP_SIZE = 19;
+    constexpr size_t MIN_BUS_SIZE = 3;
+    constexpr size_t MIN_DISTANCE_SIZE = 2;
+
+    enum class ColorTag : uint8_t {
+        NONE,
+        NAME,
+        RGB,
+        RGBA
+    };
+
+    uint64_t ZigZag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    int64_t UnZigZag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // Names numbered in order of first appearance, so consecutive stops mostly get consecutive ids.
+    class NameTable {
+    public:
+        explicit NameTable(const DBQueries& queries) {
+            for (const Stop& stop : queries.stops) {
+                Add(stop.name);
+                for (const auto& [stop_name, distance] : stop.road_distances) {
+                    Add(stop_name);
+                }
+            }
+            for (const Bus& bus : queries.buses) {
+                Add(bus.name);
+                for (std::string_view stop_name : bus.stops) {
+                    Add(stop_name);
+                }
+            }
+        }
+
+        uint64_t GetId(std::string_view name) const {
+            return ids_.at(name);
+        }
+
+        const std::vector<std::string_view>& GetNames() const {
+            return names_;
+        }
+
+    private:
+        void Add(std::string_view name) {
+            if (ids_.emplace(name, names_.size()).second) {
+                names_.push_back(name);
+            }
+        }
+
+        std::unordered_map<std::string_view, uint64_t> ids_;
+        std::vector<std::string_view> names_;
+    };
+
+    // The base is put together in memory and written out at once.
+    class Writer {
+    public:
+        void WriteVarint(uint64_t value) {
+            while (value >= 0x80) {
+                buffer_.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            buffer_.push_back(static_cast<char>(value));
+        }
+
+        void WriteSigned(int64_t value) {
+            WriteVarint(ZigZag(value));
+        }
+
+        // written as the difference from previous, which then becomes id
+        void WriteId(uint64_t id, uint64_t& previous) {
+            WriteSigned(static_cast<int64_t>(id - previous));
+            previous = id;
+        }
+
+        void WriteByte(uint8_t value) {
+            buffer_.push_back(static_cast<char>(value));
+        }
+
+        void WriteDouble(double value) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            for (int i = 0; i < 8; ++i) {
+                buffer_.push_back(static_cast<char>(bits >> (8 * i)));
+            }
+        }
+
+        void WriteBytes(std::string_view bytes) {
+            buffer_.append(bytes);
+        }
+
+        void WriteString(std::string_view str) {
+            WriteVarint(str.size());
+            WriteBytes(str);
+        }
+
+        void WritePoint(svg::Point point) {
+            WriteDouble(point.x);
+            WriteDouble(point.y);
+        }
+
+        void WriteColor(const svg::Color& color) {
+            if (const auto* name = std::get_if<std::string>(&color)) {
+                WriteByte(static_cast<uint8_t>(ColorTag::NAME));
+                WriteString(*name);
+            } else if (const auto* rgb = std::get_if<svg::Rgb>(&color)) {
+                WriteByte(static_cast<uint8_t>(ColorTag::RGB));
+                WriteByte(rgb->red);
+                WriteByte(rgb->green);
+                WriteByte(rgb->blue);
+            } else if (const auto* rgba = std::get_if<svg::Rgba>(&color)) {
+                WriteByte(static_cast<uint8_t>(ColorTag::RGBA));
+                WriteByte(rgba->red);
+                WriteByte(rgba->green);
+                WriteByte(rgba->blue);
+                WriteDouble(rgba->opacity);
+            } else {
+                WriteByte(static_cast<uint8_t>(ColorTag::NONE));
+            }
+        }
+
+        const std::string& GetBuffer() const {
+            return buffer_;
+        }
+
+    private:
+        std::string buffer_;
+    };
+
+    // Every read is checked against the end of the data, so a broken base throws instead of reading past it.
+    class Reader {
+    public:
+        explicit Reader(std::string_view data)
+            : data_(data) {
+        }
+
+        uint64_t ReadVarint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                const uint8_t byte = ReadByte();
+                value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return value;
+                }
+            }
+            throw BaseFormatError("Varint is too long"s);
+        }
+
+        int ReadInt() {
+            const int64_t value = UnZigZag(ReadVarint());
+            if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+                throw BaseFormatError("Integer is out of range"s);
+            }
+            return static_cast<int>(value);
+        }
+
+        // count of items taking at least item_size bytes each
+        size_t ReadCount(size_t item_size) {
+            const uint64_t count = ReadVarint();
+            if (count > data_.size() / item_size) {
+                throw BaseFormatError("Count is larger than the data left"s);
+            }
+            return static_cast<size_t>(count);
+        }
+
+        // the name that is id after adding the difference read to previous
+        std::string_view ReadName(const std::vector<std::string_view>& names, uint64_t& previous) {
+            previous += static_cast<uint64_t>(UnZigZag(ReadVarint()));
+            if (previous >= names.size()) {
+                throw BaseFormatError("Name id is out of range"s);
+            }
+            return names[previous];
+        }
+
+        uint8_t ReadByte() {
+            return static_cast<uint8_t>(ReadBytes(1)[0]);
+        }
+
+        double ReadDouble() {
+            const std::string_view bytes = ReadBytes(8);
+            uint64_t bits = 0;
+            for (int i = 0; i < 8; ++i) {
+                bits |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+            }
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        std::string_view ReadBytes(size_t size) {
+            if (size > data_.size()) {
+                throw BaseFormatError("Unexpected end of base"s);
+            }
+            const std::string_view bytes = data_.substr(0, size);
+            data_.remove_prefix(size);
+            return bytes;
+        }
+
+        std::string_view ReadString() {
+            return ReadBytes(ReadCount(1));
+        }
+
+        svg::Point ReadPoint() {
+            const double x = ReadDouble();
+            return {x, ReadDouble()};
+        }
+
+        svg::Color ReadColor() {
+            switch (static_cast<ColorTag>(ReadByte())) {
+            case ColorTag::NONE:
+                return svg::NoneColor;
+            case ColorTag::NAME:
+                return std::string(ReadString());
+            case ColorTag::RGB: {
+                const std::string_view rgb = ReadBytes(3);
+                return svg::Rgb{static_cast<uint8_t>(rgb[0]), static_cast<uint8_t>(rgb[1]), static_cast<uint8_t>(rgb[2])};
+            }
+            case ColorTag::RGBA: {
+                const std::string_view rgb = ReadBytes(3);
+                return svg::Rgba{static_cast<uint8_t>(rgb[0]), static_cast<uint8_t>(rgb[1]), static_cast<uint8_t>(rgb[2]), ReadDouble()};
+            }
+            }
+            throw BaseFormatError("Unknown color"s);
+        }
+
+        bool AtEnd() const {
+            return data_.empty();
+        }
+
+    private:
+        std::string_view data_;
+    };
+
+    void WriteRenderSettings(Writer& writer, const RenderSettings& settings) {
+        writer.WriteVarint(settings.palette.size());
+        for (const svg::Color& color : settings.palette) {
+            writer.WriteColor(color);
+        }
+        writer.WriteDouble(settings.width);
+        writer.WriteDouble(settings.height);
+        writer.WriteDouble(settings.padding);
+        writer.WriteDouble(settings.line_width);
+        writer.WriteDouble(settings.stop_radius);
+        writer.WriteSigned(settings.bus_label_font_size);
+        writer.WritePoint(settings.bus_label_offset);
+        writer.WriteSigned(settings.stop_label_font_size);
+        writer.WritePoint(settings.stop_label_offset);
+        writer.WriteColor(settings.underlayer_color);
+        writer.WriteDouble(settings.underlayer_width);
+    }
+
+    RenderSettings ReadRenderSettings(Reader& reader) {
+        RenderSettings settings;
+        settings.palette.resize(reader.ReadCount(1));
+        for (svg::Color& color : settings.palette) {
+            color = reader.ReadColor();
+        }
+        settings.width = reader.ReadDouble();
+        settings.height = reader.ReadDouble();
+        settings.padding = reader.ReadDouble();
+        settings.line_width = reader.ReadDouble();
+        settings.stop_radius = reader.ReadDouble();
+        settings.bus_label_font_size = reader.ReadInt();
+        settings.bus_label_offset = reader.ReadPoint();
+        settings.stop_label_font_size = reader.ReadInt();
+        settings.stop_label_offset = reader.ReadPoint();
+        settings.underlayer_color = reader.ReadColor();
+        settings.underlayer_width = reader.ReadDouble();
+        return settings;
+    }
+
+    void WriteRoutingSettings(Writer& writer, const RoutingSettings& settings) {
+        writer.WriteSigned(settings.bus_wait_time);
+        writer.WriteDouble(settings.bus_velocity);
+        writer.WriteDouble(settings.walk_velocity);
+        writer.WriteSigned(settings.walk_stop_candidates);
+        writer.WriteDouble(settings.walk_transfer_distance);
+        writer.WriteByte(static_cast<uint8_t>(settings.distance_formula));
+    }
+
+    RoutingSettings ReadRoutingSettings(Reader& reader, uint64_t version) {
+        RoutingSettings settings;
+        settings.bus_wait_time = reader.ReadInt();
+        settings.bus_velocity = reader.ReadDouble();
+        settings.walk_velocity = reader.ReadDouble();
+        settings.walk_stop_candidates = reader.ReadInt();
+        settings.walk_transfer_distance = reader.ReadDouble();
+        if (version >= 2) {
+            const uint8_t formula = reader.ReadByte();
+            if (formula > static_cast<uint8_t>(geo::DistanceFormula::HAVERSINE)) {
+                throw BaseFormatError("Unknown distance formula"s);
+            }
+            settings.distance_formula = static_cast<geo::DistanceFormula>(formula);
+        }
+        return settings;
+    }
+}
+
+void SaveBase(const DBQueries& queries, std::ostream& output) {
+    const NameTable names(queries);
+    Writer writer;
+    writer.WriteBytes(MAGIC);
+    writer.WriteVarint(BASE_FORMAT_VERSION);
+
+    writer.WriteVarint(names.GetNames().size());
+    for (std::string_view name : names.GetNames()) {
+        writer.WriteString(name);
+    }
+
+    writer.WriteVarint(queries.stops.size());
+    uint64_t previous_stop = 0;
+    for (const Stop& stop : queries.stops) {
+        writer.WriteId(names.GetId(stop.name), previous_stop);
+        writer.WriteDouble(stop.position.lat);
+        writer.WriteDouble(stop.position.lng);
+        writer.WriteVarint(stop.road_distances.size());
+        uint64_t previous_to = previous_stop;
+        for (const auto& [stop_name, distance] : stop.road_distances) {
+            writer.WriteId(names.GetId(stop_name), previous_to);
+            writer.WriteSigned(distance);
+        }
+    }
+
+    writer.WriteVarint(queries.buses.size());
+    uint64_t previous_bus = 0;
+    for (const Bus& bus : queries.buses) {
+        writer.WriteId(names.GetId(bus.name), previous_bus);
+        writer.WriteByte(bus.is_roundtrip ? 1 : 0);
+        writer.WriteVarint(bus.stops.size());
+        uint64_t previous_stop_on_bus = 0;
+        for (std::string_view stop_name : bus.stops) {
+            writer.WriteId(names.GetId(stop_name), previous_stop_on_bus);
+        }
+    }
+
+    WriteRenderSettings(writer, queries.render_settings);
+    WriteRoutingSettings(writer, queries.routing_settings);
+
+    const std::string& buffer = writer.GetBuffer();
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+}
+
+DBQueries LoadBase(std::string_view data) {
+    Reader reader(data);
+    if (data.substr(0, MAGIC.size()) != MAGIC) {
+        throw BaseFormatError("Not a catalogue base"s);
+    }
+    reader.ReadBytes(MAGIC.size());
+    const uint64_t version = reader.ReadVarint();
+    if (version == 0 || version > BASE_FORMAT_VERSION) {
+        throw BaseFormatError("Unsupported base version "s + std::to_string(version));
+    }
+
+    DBQueries queries;
+    // the table holds every name once, so interning it is all the hashing the load does
+    std::vector<std::string_view> names(reader.ReadCount(1));
+    queries.names.Reserve(names.size());
+    for (std::string_view& name : names) {
+        name = queries.names.Intern(reader.ReadString());
+    }
+
+    const size_t stops_count = reader.ReadCount(MIN_STOP_SIZE);
+    uint64_t previous_stop = 0;
+    for (size_t i = 0; i < stops_count; ++i) {
+        Stop& stop = queries.stops.emplace_back();
+        stop.name = reader.ReadName(names, previous_stop);
+        stop.position.lat = reader.ReadDouble();
+        stop.position.lng = reader.ReadDouble();
+        const size_t distances_count = reader.ReadCount(MIN_DISTANCE_SIZE);
+        uint64_t previous_to = previous_stop;
+        for (size_t j = 0; j < distances_count; ++j) {
+            const std::string_view stop_name = reader.ReadName(names, previous_to);
+            stop.road_distances.emplace_back(stop_name, reader.ReadInt());
+        }
+    }
+
+    const size_t buses_count = reader.ReadCount(MIN_BUS_SIZE);
+    uint64_t previous_bus = 0;
+    for (size_t i = 0; i < buses_count; ++i) {
+        Bus& bus = queries.buses.emplace_back();
+        bus.name = reader.ReadName(names, previous_bus);
+        bus.is_roundtrip = reader.ReadByte() != 0;
+        const size_t stops_on_bus = reader.ReadCount(1);
+        uint64_t previous_stop_on_bus = 0;
+        for (size_t j = 0; j < stops_on_bus; ++j) {
+            bus.stops.push_back(reader.ReadName(names, previous_stop_on_bus));
+        }
+    }
+
+    queries.render_settings = ReadRenderSettings(reader);
+    queries.routing_settings = ReadRoutingSettings(reader, version);
+    if (!reader.AtEnd()) {
+        throw BaseFormatError("Unexpected data after the base"s);
+    }
+    return queries;
+}
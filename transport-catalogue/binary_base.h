@@ -0,0 +1,35 @@
+#pragma once
+
+#include "json_reader.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string_view>
+
+// Compact binary form of the base part of DBQueries: stops, buses, road distances, render and routing
+// settings (stat requests stay in JSON). Meant to be converted once from the JSON input and then loaded
+// on every start.
+//
+// Layout, all integers as LEB128 varints (signed ones zigzag-coded), doubles as 8 little-endian bytes:
+//   "TCDB" version
+//   strings: count, then length and bytes of each distinct name
+//   stops:   count, then for each: name id (delta from the previous stop's), latitude, longitude,
+//            distances count and (stop id delta from the previous one, metres) pairs
+//   buses:   count, then for each: name id (delta from the previous bus's), is_roundtrip,
+//            stops count and stop ids (each a delta from the previous one)
+//   render settings, routing settings (with the distance formula byte since version 2)
+// Names are referenced by their index in the string table.
+class BaseFormatError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// bases of earlier versions are read too
+inline constexpr uint32_t BASE_FORMAT_VERSION = 2;
+
+// stat requests are not written
+void SaveBase(const DBQueries& queries, std::ostream& output);
+// the names are interned into the result, so data may go away afterwards;
+// throws BaseFormatError for data that is not a base of a version this build reads
+DBQueries LoadBase(std::string_view data);
@@ -0,0 +1,109 @@
+#include "city_catalogues.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+using namespace std::literals;
+
+CityCatalogues::CityCatalogues(size_t threads_count)
+    : names_(std::make_shared<SharedStringArena>())
+    , pool_(std::max<size_t>(1, threads_count)) {
+}
+
+std::future<void> CityCatalogues::Load(std::string city, DBQueries&& base) {
+    // the parsed names must outlive the build, which copies them into the shared arena
+    auto parsed = std::make_shared<DBQueries>(std::move(base));
+
+    // every worker may be building a city at once, so each gets its share of the cores
+    const size_t freeze_threads_count = std::max<size_t>(1, std::thread::hardware_concurrency() / pool_.GetThreadsCount());
+
+    return pool_.Submit([this, city = std::move(city), parsed, freeze_threads_count] {
+        auto snapshot = std::make_unique<const CatalogueSnapshot>(names_, std::move(parsed->stops), std::move(parsed->buses),
+                                                                  parsed->render_settings, parsed->routing_settings,
+                                                                  freeze_threads_count);
+        std::shared_ptr<VersionedCatalogue> versions;
+        {
+            std::unique_lock lock(cities_mutex_);
+            auto& slot = cities_[city];
+            if (!slot) {
+                slot = std::make_shared<VersionedCatalogue>();
+            }
+            versions = slot;
+        }
+        versions->Publish(std::move(snapshot));
+    });
+}
+
+bool CityCatalogues::Unload(std::string_view city) {
+    std::unique_lock lock(cities_mutex_);
+    const auto it = cities_.find(city);
+    if (it == cities_.end()) {
+        return false;
+    }
+    cities_.erase(it);
+    return true;
+}
+
+bool CityCatalogues::IsLoaded(std::string_view city) const {
+    return FindCity(city) != nullptr;
+}
+
+std::vector<std::string> CityCatalogues::GetCities() const {
+    std::shared_lock lock(cities_mutex_);
+    std::vector<std::string> cities;
+    cities.reserve(cities_.size());
+    for (const auto& [city, versions] : cities_) {
+        cities.push_back(city);
+    }
+    return cities;
+}
+
+json::Array CityCatalogues::Answer(const std::deque<Stat>& queries) const {
+    // positions of the requests of each city, so every city is answered by one task
+    std::map<std::string_view, std::vector<size_t>> by_city;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto city_it = queries[i].key_values.find("city"s);
+        by_city[city_it != queries[i].key_values.end() ? std::string_view(city_it->second) : std::string_view()].push_back(i);
+    }
+
+    json::Array answer(queries.size());
+    std::vector<std::future<void>> tasks;
+    for (const auto& [city, positions] : by_city) {
+        tasks.push_back(pool_.Submit([this, &queries, &answer, city = city, &positions = positions] {
+            // the guard is declared after versions and released first, even if the city is unloaded meanwhile
+            const std::shared_ptr<VersionedCatalogue> versions = FindCity(city);
+            const auto snapshot = versions ? std::optional(versions->Read()) : std::nullopt;
+            if (!snapshot || !*snapshot) {
+                for (size_t position : positions) {
+                    answer[position] = Generate_Error_Message_Dict(queries[position].id);
+                }
+                return;
+            }
+
+            std::deque<Stat> city_queries;
+            for (size_t position : positions) {
+                city_queries.push_back(queries[position]);
+            }
+            json::Array city_answer = GetAnswer(city_queries, (*snapshot)->GetRequestHandler());
+            for (size_t i = 0; i < positions.size(); ++i) {
+                answer[positions[i]] = std::move(city_answer[i]);
+            }
+        }));
+    }
+    for (auto& task : tasks) {
+        task.get();
+    }
+    return answer;
+}
+
+const SharedStringArena& CityCatalogues::GetNames() const {
+    return *names_;
+}
+
+std::shared_ptr<VersionedCatalogue> CityCatalogues::FindCity(std::string_view city) const {
+    std::shared_lock lock(cities_mutex_);
+    const auto it = cities_.find(city);
+    return it != cities_.end() ? it->second : nullptr;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "json.h"
+#include "json_reader.h"
+#include "string_arena.h"
+#include "thread_pool.h"
+#include "versioned_catalogue.h"
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Several cities served from one process. Every city has its own catalogue, graph and router
+// (nothing is looked up across cities); the name arena and the worker pool are shared.
+// Stat requests pick their city with a "city" key.
+class CityCatalogues {
+public:
+    explicit CityCatalogues(size_t threads_count = std::thread::hardware_concurrency());
+
+    // builds the city on the pool; a city already loaded under that name is replaced
+    // without disturbing requests in flight
+    std::future<void> Load(std::string city, DBQueries&& base);
+    // requests in flight keep the old data until they finish; false for an unknown city
+    bool Unload(std::string_view city);
+    bool IsLoaded(std::string_view city) const;
+    std::vector<std::string> GetCities() const;
+
+    // answers in request order; a request for a city that is not loaded gets "not found".
+    // Must not be called from a task running on this pool.
+    json::Array Answer(const std::deque<Stat>& queries) const;
+
+    const SharedStringArena& GetNames() const;
+
+private:
+    std::shared_ptr<VersionedCatalogue> FindCity(std::string_view city) const;
+
+    std::shared_ptr<SharedStringArena> names_;
+    mutable std::shared_mutex cities_mutex_;
+    std::map<std::string, std::shared_ptr<VersionedCatalogue>, std::less<>> cities_;
+    // last, so the workers are joined before the cities they may be building go away
+    mutable ThreadPool pool_;
+};
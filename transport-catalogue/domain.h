@@ -1,22 +1,28 @@
 #pragma once
 
 #include "geo.h"
+#include "ranges.h"
 
 #include <array>
+#include <cstdint>
 #include <deque>
 #include <set>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
+// Names are views into a StringArena owned by whoever holds the stops and buses
+// (DBQueries after parsing, TransportCatalogue after filling).
 struct Stop {
-    std::string name;
+    std::string_view name;
     geo::Coordinates position;
-    std::deque<std::pair<std::string, int>> road_distances;
+    std::deque<std::pair<std::string_view, int>> road_distances;
 };
 
 struct Bus {
-    std::string name;
-    std::deque<std::string> stops;
+    std::string_view name;
+    std::deque<std::string_view> stops;
     bool is_roundtrip;
 };
 
@@ -24,25 +30,81 @@ enum class RequestType {
     BUS,
     STOP,
     MAP,
-    ROUTE
+    ROUTE,
+    SEGMENT,
+    NEAREST_STOPS,
+    STOPS_IN_BOX,
+    NETWORK_SUMMARY,
+    LONGEST_ROUTES,
+    CURVATURE_DISTRIBUTION,
+    NAME_SEARCH,
+    COMPONENTS
 };  
 
 struct Stat {
     int id;
     RequestType type;
     std::unordered_map<std::string, std::string> key_values;
+    std::unordered_map<std::string, double> key_numbers;
 };
 
 struct BusStat {
-    std::string bus_name;
+    std::string_view bus_name;
     int stops_count = 0;
     int unique_stops = 0;
     double length = 0.0;
     double curvature = 0.0;
 };
 
+struct SegmentStat {
+    int route_length = 0;
+    double gps_length = 0.0;
+};
+
+struct NetworkSummary {
+    int stops_count = 0;
+    // stops with at least one bus
+    int served_stops_count = 0;
+    int buses_count = 0;
+    int roundtrip_buses_count = 0;
+    // stop visits summed over all rides, as in BusStat::stops_count
+    int64_t route_stops_count = 0;
+    double total_length = 0.0;
+    double average_length = 0.0;
+    double average_curvature = 0.0;
+    geo::Coordinates min{0.0, 0.0};
+    geo::Coordinates max{0.0, 0.0};
+};
+
+struct ComponentStat {
+    int strong_count = 0;
+    int largest_strong_size = 0;
+    int weak_count = 0;
+    int largest_weak_size = 0;
+    // stops no bus or walk leaves or reaches
+    int isolated_count = 0;
+};
+
+struct RouteLength {
+    std::string_view bus_name;
+    double length = 0.0;
+};
+
+struct CurvatureDistribution {
+    double min = 0.0;
+    double max = 0.0;
+    std::vector<int> counts;
+};
+
+struct StopDistance {
+    const Stop* stop = nullptr;
+    double distance = 0.0;
+};
+
+using BusesRange = ranges::Range<std::vector<const Bus*>::const_iterator>;
+
 struct BusesToStop {
-    std::string stop_name;
+    std::string_view stop_name;
     bool notFound = true;
-    std::set<std::string_view> buses;
+    BusesRange buses{{}, {}};
 };
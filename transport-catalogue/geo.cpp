@@ -1,16 +1,169 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace geo {
 
+namespace {
+
+const double EARTH_RADIUS = 6371000;
+const double DR = M_PI / 180.0;
+// the series below is exact to the last bit up to here; larger arguments (hops over ~600 km) use std::asin
+const double ASIN_SERIES_LIMIT = 0.05;
+
+// asin(t) for 0 <= t <= ASIN_SERIES_LIMIT
+double AsinSeries(double t) {
+    const double t2 = t * t;
+    return t * (1.0 + t2 * (1.0 / 6 + t2 * (3.0 / 40 + t2 * (5.0 / 112 + t2 * (35.0 / 1152 + t2 * (63.0 / 2816))))));
+}
+
+// sin of half the central angle: half the chord between the unit vectors
+double HalfChord(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    const double dx = from.x - to.x;
+    const double dy = from.y - to.y;
+    const double dz = from.sin_lat - to.sin_lat;
+    return std::min(1.0, std::sqrt(dx * dx + dy * dy + dz * dz) * 0.5);
+}
+
+double HalfChordToDistance(double half_chord) {
+    return 2 * EARTH_RADIUS * (half_chord <= ASIN_SERIES_LIMIT ? AsinSeries(half_chord) : std::asin(half_chord));
+}
+
+#if defined(__AVX2__)
+
+// four pairs at a time; lanes past the series limit are redone in scalar code
+size_t ComputeHaversineDistancesSimd(const PreparedCoordinates* from, const PreparedCoordinates* to, size_t count, double* distances) {
+    auto load = [](const PreparedCoordinates* p, double PreparedCoordinates::*field) {
+        return _mm256_set_pd(p[3].*field, p[2].*field, p[1].*field, p[0].*field);
+    };
+    auto poly = [](__m256d t2, double c, __m256d acc) {
+        return _mm256_add_pd(_mm256_set1_pd(c), _mm256_mul_pd(t2, acc));
+    };
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256d dx = _mm256_sub_pd(load(from + i, &PreparedCoordinates::x), load(to + i, &PreparedCoordinates::x));
+        const __m256d dy = _mm256_sub_pd(load(from + i, &PreparedCoordinates::y), load(to + i, &PreparedCoordinates::y));
+        const __m256d dz = _mm256_sub_pd(load(from + i, &PreparedCoordinates::sin_lat), load(to + i, &PreparedCoordinates::sin_lat));
+        const __m256d chord2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+        const __m256d t = _mm256_min_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_sqrt_pd(chord2), _mm256_set1_pd(0.5)));
+        const __m256d t2 = _mm256_mul_pd(t, t);
+
+        __m256d acc = _mm256_set1_pd(63.0 / 2816);
+        acc = poly(t2, 35.0 / 1152, acc);
+        acc = poly(t2, 5.0 / 112, acc);
+        acc = poly(t2, 3.0 / 40, acc);
+        acc = poly(t2, 1.0 / 6, acc);
+        acc = poly(t2, 1.0, acc);
+        _mm256_storeu_pd(distances + i, _mm256_mul_pd(_mm256_set1_pd(2 * EARTH_RADIUS), _mm256_mul_pd(t, acc)));
+
+        if (const int far = _mm256_movemask_pd(_mm256_cmp_pd(t, _mm256_set1_pd(ASIN_SERIES_LIMIT), _CMP_GT_OQ)); far != 0) {
+            for (size_t lane = 0; lane < 4; ++lane) {
+                if (far & (1 << lane)) {
+                    distances[i + lane] = HalfChordToDistance(HalfChord(from[i + lane], to[i + lane]));
+                }
+            }
+        }
+    }
+    return i;
+}
+
+#elif defined(__SSE2__)
+
+// two pairs at a time; lanes past the series limit are redone in scalar code
+size_t ComputeHaversineDistancesSimd(const PreparedCoordinates* from, const PreparedCoordinates* to, size_t count, double* distances) {
+    auto load = [](const PreparedCoordinates* p, double PreparedCoordinates::*field) {
+        return _mm_set_pd(p[1].*field, p[0].*field);
+    };
+    auto poly = [](__m128d t2, double c, __m128d acc) {
+        return _mm_add_pd(_mm_set1_pd(c), _mm_mul_pd(t2, acc));
+    };
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128d dx = _mm_sub_pd(load(from + i, &PreparedCoordinates::x), load(to + i, &PreparedCoordinates::x));
+        const __m128d dy = _mm_sub_pd(load(from + i, &PreparedCoordinates::y), load(to + i, &PreparedCoordinates::y));
+        const __m128d dz = _mm_sub_pd(load(from + i, &PreparedCoordinates::sin_lat), load(to + i, &PreparedCoordinates::sin_lat));
+        const __m128d chord2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        const __m128d t = _mm_min_pd(_mm_set1_pd(1.0), _mm_mul_pd(_mm_sqrt_pd(chord2), _mm_set1_pd(0.5)));
+        const __m128d t2 = _mm_mul_pd(t, t);
+
+        __m128d acc = _mm_set1_pd(63.0 / 2816);
+        acc = poly(t2, 35.0 / 1152, acc);
+        acc = poly(t2, 5.0 / 112, acc);
+        acc = poly(t2, 3.0 / 40, acc);
+        acc = poly(t2, 1.0 / 6, acc);
+        acc = poly(t2, 1.0, acc);
+        _mm_storeu_pd(distances + i, _mm_mul_pd(_mm_set1_pd(2 * EARTH_RADIUS), _mm_mul_pd(t, acc)));
+
+        if (const int far = _mm_movemask_pd(_mm_cmpgt_pd(t, _mm_set1_pd(ASIN_SERIES_LIMIT))); far != 0) {
+            for (size_t lane = 0; lane < 2; ++lane) {
+                if (far & (1 << lane)) {
+                    distances[i + lane] = HalfChordToDistance(HalfChord(from[i + lane], to[i + lane]));
+                }
+            }
+        }
+    }
+    return i;
+}
+
+#else
+
+size_t ComputeHaversineDistancesSimd(const PreparedCoordinates*, const PreparedCoordinates*, size_t, double*) {
+    return 0;
+}
+
+#endif
+
+}  // namespace
+
 double ComputeDistance(Coordinates from, Coordinates to) {
     using namespace std;
     const double dr = M_PI / 180.0;
-    return acos(sin(from.lat * dr) * sin(to.lat * dr)
-                + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
+    // clamped because rounding can push the cosine of a zero angle above 1
+    return acos(min(1.0, sin(from.lat * dr) * sin(to.lat * dr)
+                         + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr)))
         * 6371000;
 }
 
-}  // namespace geo
\ No newline at end of file
+PreparedCoordinates Prepare(Coordinates point) {
+    PreparedCoordinates prepared;
+    prepared.lng = point.lng;
+    prepared.sin_lat = std::sin(point.lat * DR);
+    prepared.cos_lat = std::cos(point.lat * DR);
+    prepared.x = prepared.cos_lat * std::cos(point.lng * DR);
+    prepared.y = prepared.cos_lat * std::sin(point.lng * DR);
+    return prepared;
+}
+
+double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    using namespace std;
+    return acos(min(1.0, from.sin_lat * to.sin_lat + from.cos_lat * to.cos_lat * cos(abs(from.lng - to.lng) * DR)))
+        * EARTH_RADIUS;
+}
+
+double ComputeHaversineDistance(const PreparedCoordinates& from, const PreparedCoordinates& to) {
+    return HalfChordToDistance(HalfChord(from, to));
+}
+
+void ComputeDistances(const PreparedCoordinates* from, const PreparedCoordinates* to, size_t count,
+                      double* distances, DistanceFormula formula) {
+    if (formula == DistanceFormula::COSINES) {
+        for (size_t i = 0; i < count; ++i) {
+            distances[i] = ComputeDistance(from[i], to[i]);
+        }
+        return;
+    }
+
+    for (size_t i = ComputeHaversineDistancesSimd(from, to, count, distances); i < count; ++i) {
+        distances[i] = ComputeHaversineDistance(from[i], to[i]);
+    }
+}
+
+}  // namespace geo
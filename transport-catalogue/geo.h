@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 namespace geo {
 
 struct Coordinates {
@@ -7,6 +9,29 @@ struct Coordinates {
     double lng; // Долгота
 };
 
+// Coordinates with the per-point trigonometry of the distance formulas done up front
+struct PreparedCoordinates {
+    double lng = 0.0;      // degrees, as in Coordinates
+    double sin_lat = 0.0;  // also z of the unit vector
+    double cos_lat = 0.0;
+    double x = 0.0;        // cos(lat) * cos(lng)
+    double y = 0.0;        // cos(lat) * sin(lng)
+};
+
+enum class DistanceFormula {
+    // spherical law of cosines, bit for bit what ComputeDistance(Coordinates, Coordinates) returns
+    COSINES,
+    // haversine through the chord between unit vectors: accurate for short hops and vectorized
+    HAVERSINE
+};
+
 double ComputeDistance(Coordinates from, Coordinates to);
 
-}  // namespace geo
\ No newline at end of file
+PreparedCoordinates Prepare(Coordinates point);
+double ComputeDistance(const PreparedCoordinates& from, const PreparedCoordinates& to);
+double ComputeHaversineDistance(const PreparedCoordinates& from, const PreparedCoordinates& to);
+// distances[i] = distance from from[i] to to[i]; the arrays may overlap (to = from + 1 gives path hops)
+void ComputeDistances(const PreparedCoordinates* from, const PreparedCoordinates* to, size_t count,
+                      double* distances, DistanceFormula formula = DistanceFormula::COSINES);
+
+}  // namespace geo
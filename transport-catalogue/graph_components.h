@@ -0,0 +1,187 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+// Strongly and weakly connected components of a directed graph, labelled once.
+// Tarjan numbers strong components in reverse topological order: an edge between two different
+// components always goes from the higher number to the lower one.
+class Components {
+public:
+    Components() = default;
+
+    template <typename Weight>
+    explicit Components(const DirectedWeightedGraph<Weight>& graph);
+
+    // false means no route for sure; true means there may be one
+    bool MayReach(VertexId from, VertexId to) const;
+
+    size_t GetStrongCount() const;
+    size_t GetWeakCount() const;
+    size_t GetLargestStrongSize() const;
+    size_t GetLargestWeakSize() const;
+    // vertices without edges in or out
+    size_t GetIsolatedCount() const;
+
+private:
+    template <typename Weight>
+    void LabelStrong(const DirectedWeightedGraph<Weight>& graph);
+    template <typename Weight>
+    void LabelWeak(const DirectedWeightedGraph<Weight>& graph);
+
+    std::vector<uint32_t> strong_;
+    std::vector<uint32_t> weak_;
+    size_t strong_count_ = 0;
+    size_t weak_count_ = 0;
+    size_t largest_strong_ = 0;
+    size_t largest_weak_ = 0;
+    size_t isolated_count_ = 0;
+};
+
+template <typename Weight>
+Components::Components(const DirectedWeightedGraph<Weight>& graph) {
+    LabelStrong(graph);
+    LabelWeak(graph);
+}
+
+inline bool Components::MayReach(VertexId from, VertexId to) const {
+    return weak_.at(from) == weak_.at(to) && strong_[from] >= strong_[to];
+}
+
+inline size_t Components::GetStrongCount() const {
+    return strong_count_;
+}
+
+inline size_t Components::GetWeakCount() const {
+    return weak_count_;
+}
+
+inline size_t Components::GetLargestStrongSize() const {
+    return largest_strong_;
+}
+
+inline size_t Components::GetLargestWeakSize() const {
+    return largest_weak_;
+}
+
+inline size_t Components::GetIsolatedCount() const {
+    return isolated_count_;
+}
+
+template <typename Weight>
+void Components::LabelStrong(const DirectedWeightedGraph<Weight>& graph) {
+    constexpr uint32_t UNVISITED = UINT32_MAX;
+    const size_t vertex_count = graph.GetVertexCount();
+    strong_.assign(vertex_count, UNVISITED);
+    std::vector<uint32_t> index(vertex_count, UNVISITED);
+    std::vector<uint32_t> low(vertex_count, 0);
+    std::vector<bool> on_stack(vertex_count, false);
+    std::vector<VertexId> stack;
+    // (vertex, position in its incidence list): Tarjan without recursion, so long chains cannot overflow
+    std::vector<std::pair<VertexId, size_t>> calls;
+    uint32_t next_index = 0;
+
+    for (VertexId root = 0; root < vertex_count; ++root) {
+        if (index[root] != UNVISITED) {
+            continue;
+        }
+        calls.push_back({root, 0});
+        while (!calls.empty()) {
+            auto& [vertex, next_edge] = calls.back();
+            if (next_edge == 0) {
+                index[vertex] = low[vertex] = next_index++;
+                stack.push_back(vertex);
+                on_stack[vertex] = true;
+            }
+
+            const auto edges = graph.GetIncidentEdges(vertex);
+            bool descended = false;
+            while (next_edge < edges.size()) {
+                const VertexId to = graph.GetEdge(*(edges.begin() + next_edge++)).to;
+                if (index[to] == UNVISITED) {
+                    calls.push_back({to, 0});
+                    descended = true;
+                    break;
+                }
+                if (on_stack[to]) {
+                    low[vertex] = std::min(low[vertex], index[to]);
+                }
+            }
+            if (descended) {
+                continue;
+            }
+
+            const VertexId done = vertex;
+            calls.pop_back();
+            if (low[done] == index[done]) {
+                size_t size = 0;
+                VertexId member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    on_stack[member] = false;
+                    strong_[member] = static_cast<uint32_t>(strong_count_);
+                    ++size;
+                } while (member != done);
+                ++strong_count_;
+                largest_strong_ = std::max(largest_strong_, size);
+            }
+            if (!calls.empty()) {
+                const VertexId parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[done]);
+            }
+        }
+    }
+}
+
+template <typename Weight>
+void Components::LabelWeak(const DirectedWeightedGraph<Weight>& graph) {
+    const size_t vertex_count = graph.GetVertexCount();
+    std::vector<VertexId> parent(vertex_count);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](VertexId vertex) {
+        while (parent[vertex] != vertex) {
+            parent[vertex] = parent[parent[vertex]];
+            vertex = parent[vertex];
+        }
+        return vertex;
+    };
+
+    std::vector<bool> has_edges(vertex_count, false);
+    for (EdgeId id = 0; id < graph.GetEdgeCount(); ++id) {
+        const auto& edge = graph.GetEdge(id);
+        has_edges[edge.from] = has_edges[edge.to] = true;
+        const VertexId from_root = find(edge.from);
+        const VertexId to_root = find(edge.to);
+        if (from_root != to_root) {
+            parent[std::max(from_root, to_root)] = std::min(from_root, to_root);
+        }
+    }
+
+    weak_.assign(vertex_count, 0);
+    std::vector<size_t> sizes;
+    std::vector<uint32_t> label(vertex_count, UINT32_MAX);
+    for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
+        const VertexId root = find(vertex);
+        if (label[root] == UINT32_MAX) {
+            label[root] = static_cast<uint32_t>(sizes.size());
+            sizes.push_back(0);
+        }
+        weak_[vertex] = label[root];
+        ++sizes[label[root]];
+        if (!has_edges[vertex]) {
+            ++isolated_count_;
+        }
+    }
+    weak_count_ = sizes.size();
+    largest_weak_ = sizes.empty() ? 0 : *std::max_element(sizes.begin(), sizes.end());
+}
+
+}  // namespace graph
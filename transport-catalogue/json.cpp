@@ -1,6 +1,12 @@
 #include "json.h"
+#include "json_parser.h"
+#include "json_scan.h"
 
+#include <cctype>
+#include <charconv>
+#include <cmath>
 #include <iterator>
+#include <string_view>
 
 namespace json {
 
@@ -106,77 +112,121 @@ namespace json {
         return *this;
     }
     
-    namespace {
+    namespace detail {
+
         using namespace std::literals;
 
-        Node LoadNode(std::istream& input);
-        Node LoadString(std::istream& input);
+        bool Parser::Fill() {
+            if (input_ == nullptr || !*input_) {
+                return false;
+            }
+            const char* keep = token_ != nullptr ? token_ : pos_;
+            const size_t pos_offset = static_cast<size_t>(pos_ - keep);
+            buffer_.erase(0, static_cast<size_t>(keep - buffer_.data()));
+
+            const size_t kept = buffer_.size();
+            buffer_.resize(kept + CHUNK_SIZE);
+            input_->read(buffer_.data() + kept, CHUNK_SIZE);
+            const size_t read = static_cast<size_t>(input_->gcount());
+            buffer_.resize(kept + read);
+
+            token_ = token_ != nullptr ? buffer_.data() : nullptr;
+            pos_ = buffer_.data() + pos_offset;
+            end_ = buffer_.data() + buffer_.size();
+            return read > 0;
+        }
 
-        std::string LoadLiteral(std::istream& input) {
-            std::string s;
-            while (std::isalpha(input.peek())) {
-                s.push_back(static_cast<char>(input.get()));
+        bool Parser::ReadChar(char& c) {
+            while ((pos_ = scan::SkipWhitespace(pos_, end_)) == end_) {
+                if (!Fill()) {
+                    return false;
+                }
             }
-            return s;
+            c = *pos_++;
+            return true;
         }
 
-        Node LoadArray(std::istream& input) {
-            std::vector<Node> result;
+        void Parser::PutBack() {
+            --pos_;
+        }
 
-            for (char c; input >> c && c != ']';) {
-                if (c != ',') {
-                    input.putback(c);
-                }
-                result.push_back(LoadNode(input));
+        std::string_view Parser::GetUnread() const {
+            return std::string_view(pos_, static_cast<size_t>(end_ - pos_));
+        }
+
+        void Parser::Skip(size_t count) {
+            pos_ += count;
+        }
+
+        int Parser::Peek() {
+            if (pos_ == end_ && !Fill()) {
+                return END;
             }
-            if (!input) {
-                throw ParsingError("Array parsing error"s);
+            return static_cast<unsigned char>(*pos_);
+        }
+
+        std::string Parser::LoadLiteral() {
+            token_ = pos_;
+            while (std::isalpha(Peek())) {
+                ++pos_;
             }
+            std::string literal(token_, pos_);
+            token_ = nullptr;
+            return literal;
+        }
+
+        Node Parser::LoadArray() {
+            Array result;
+            ReadArray([this, &result] {
+                result.push_back(LoadNode());
+            });
             return Node(std::move(result));
         }
 
-        Node LoadDict(std::istream& input) {
+        Node Parser::LoadDict() {
             Dict dict;
-
-            for (char c; input >> c && c != '}';) {
-                if (c == '"') {
-                    std::string key = LoadString(input).AsString();
-                    if (input >> c && c == ':') {
-                        if (dict.find(key) != dict.end()) {
-                            throw ParsingError("Duplicate key '"s + key + "' have been found");
-                        }
-                        dict.emplace(std::move(key), LoadNode(input));
-                    } else {
-                        throw ParsingError(": is expected but '"s + c + "' has been found"s);
-                    }
-                } else if (c != ',') {
-                    throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            ReadDict([this, &dict](std::string_view key_view) {
+                std::string key(key_view);
+                const auto it = dict.lower_bound(key);
+                if (it != dict.end() && it->first == key) {
+                    throw ParsingError("Duplicate key '"s + key + "' have been found");
                 }
-            }
-            if (!input) {
-                throw ParsingError("Dictionary parsing error"s);
-            }
+                dict.emplace_hint(it, std::move(key), LoadNode());
+            });
             return Node(std::move(dict));
         }
 
-        Node LoadString(std::istream& input) {
-            auto it = std::istreambuf_iterator<char>(input);
-            auto end = std::istreambuf_iterator<char>();
-            std::string s;
+        std::string_view Parser::LoadStringView(std::string& unescaped) {
+            const char* begin = pos_;
+            pos_ = scan::FindStringSpecial(pos_, end_);
+            if (pos_ != end_ && *pos_ == '"') {
+                ++pos_;
+                return std::string_view(begin, static_cast<size_t>(pos_ - 1 - begin));
+            }
+            unescaped.assign(begin, pos_);
+            ContinueString(unescaped);
+            return unescaped;
+        }
+
+        std::string Parser::LoadString() {
+            std::string unescaped;
+            const std::string_view s = LoadStringView(unescaped);
+            return s.data() == unescaped.data() ? std::move(unescaped) : std::string(s);
+        }
+
+        void Parser::ContinueString(std::string& s) {
             while (true) {
-                if (it == end) {
-                    throw ParsingError("String parsing error");
-                }
-                const char ch = *it;
-                if (ch == '"') {
-                    ++it;
-                    break;
+                if (pos_ == end_) {
+                    if (!Fill()) {
+                        throw ParsingError("String parsing error");
+                    }
+                } else if (const char ch = *pos_++; ch == '"') {
+                    return;
                 } else if (ch == '\\') {
-                    ++it;
-                    if (it == end) {
+                    if (pos_ == end_ && !Fill()) {
                         throw ParsingError("String parsing error");
                     }
-                    const char escaped_char = *(it);
+                    const char escaped_char = *pos_++;
                     switch (escaped_char) {
                         case 'n':
                             s.push_back('\n');
@@ -196,19 +246,19 @@ namespace json {
                         default:
                             throw ParsingError("Unrecognized escape sequence \\"s + escaped_char);
                     }
-                } else if (ch == '\n' || ch == '\r') {
-                    throw ParsingError("Unexpected end of line"s);
                 } else {
-                    s.push_back(ch);
+                    throw ParsingError("Unexpected end of line"s);
                 }
-                ++it;
-            }
 
-            return Node(std::move(s));
+                // copy the run of ordinary characters in one go
+                const char* run = pos_;
+                pos_ = scan::FindStringSpecial(pos_, end_);
+                s.append(run, pos_);
+            }
         }
 
-        Node LoadBool(std::istream& input) {
-            const auto s = LoadLiteral(input);
+        Node Parser::LoadBool() {
+            const auto s = LoadLiteral();
             if (s == "true"sv) {
                 return Node{true};
             } else if (s == "false"sv) {
@@ -218,55 +268,66 @@ namespace json {
             }
         }
 
-        Node LoadNull(std::istream& input) {
-            if (auto literal = LoadLiteral(input); literal == "null"sv) {
+        Node Parser::LoadNull() {
+            if (auto literal = LoadLiteral(); literal == "null"sv) {
                 return Node{nullptr};
             } else {
                 throw ParsingError("Failed to parse '"s + literal + "' as null"s);
             }
         }
 
-        Node LoadNumber(std::istream& input) {
-            std::string parsed_num;
-            auto read_char = [&parsed_num, &input] {
-                parsed_num += static_cast<char>(input.get());
-                if (!input) {
-                    throw ParsingError("Failed to read number from stream"s);
-                }
-            };
-            auto read_digits = [&input, read_char] {
-                if (!std::isdigit(input.peek())) {
+        Node Parser::LoadNumber() {
+            token_ = pos_;
+            auto read_digits = [this] {
+                if (!std::isdigit(Peek())) {
                     throw ParsingError("A digit is expected"s);
                 }
-                while (std::isdigit(input.peek())) {
-                    read_char();
+                while (std::isdigit(Peek())) {
+                    ++pos_;
                 }
             };
 
-            if (input.peek() == '-') {
-                read_char();
+            if (Peek() == '-') {
+                ++pos_;
             }
-            if (input.peek() == '0') {
-                read_char();
+            if (Peek() == '0') {
+                ++pos_;
             } else {
                 read_digits();
             }
             
             bool is_int = true;
             
-            if (input.peek() == '.') {
-                read_char();
+            if (Peek() == '.') {
+                ++pos_;
                 read_digits();
                 is_int = false;
             }
-            if (int ch = input.peek(); ch == 'e' || ch == 'E') {
-                read_char();
-                if (ch = input.peek(); ch == '+' || ch == '-') {
-                    read_char();
+            if (int ch = Peek(); ch == 'e' || ch == 'E') {
+                ++pos_;
+                if (ch = Peek(); ch == '+' || ch == '-') {
+                    ++pos_;
                 }
                 read_digits();
                 is_int = false;
             }
+            const char* begin = token_;
+            token_ = nullptr;
+
+            // from_chars is exact and does not allocate; values it cannot represent as normal numbers
+            // go through stod, which decides as before whether they are an error
+            if (is_int) {
+                int value;
+                if (const auto [end, ec] = std::from_chars(begin, pos_, value); ec == std::errc()) {
+                    return value;
+                }
+            }
+            if (double value; std::from_chars(begin, pos_, value).ec == std::errc()
+                              && std::fpclassify(value) != FP_SUBNORMAL) {
+                return value;
+            }
+
+            const std::string parsed_num(begin, pos_);
             try {
                 if (is_int) {
                     try {
@@ -280,32 +341,44 @@ namespace json {
             }
         }
 
-        Node LoadNode(std::istream& input) {
+        Node Parser::LoadScalar(char first) {
+            switch (first) {
+                case '"':
+                    return LoadString();
+                case 't':
+                    [[fallthrough]];
+                case 'f':
+                    --pos_;
+                    return LoadBool();
+                case 'n':
+                    --pos_;
+                    return LoadNull();
+                default:
+                    --pos_;
+                    return LoadNumber();
+            }
+        }
+
+        Node Parser::LoadNode() {
             char c;
-            if (!(input >> c)) {
+            if (!ReadChar(c)) {
                 throw ParsingError("Unexpected EOF"s);
             }
             switch (c) {
                 case '[':
-                    return LoadArray(input);
+                    return LoadArray();
                 case '{':
-                    return LoadDict(input);
-                case '"':
-                    return LoadString(input);
-                case 't':
-                    [[fallthrough]];
-                case 'f':
-                    input.putback(c);
-                    return LoadBool(input);
-                case 'n':
-                    input.putback(c);
-                    return LoadNull(input);
+                    return LoadDict();
                 default:
-                    input.putback(c);
-                    return LoadNumber(input);
+                    return LoadScalar(c);
             }
         }
 
+    }
+
+    namespace {
+        using namespace std::literals;
+
         struct PrintContext {
             std::ostream& out;
             int indent_step = 4;
@@ -357,6 +430,29 @@ template <>
     PrintString(value, ctx.out);
 }
 
+        template <>
+        void PrintValue<int>(const int& value, const PrintContext& ctx) {
+            char buffer[16];
+            const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+            ctx.out.write(buffer, result.ptr - buffer);
+        }
+
+        // the same text as `out << value`: printf's %g at the stream precision, 6 unless changed
+        template <>
+        void PrintValue<double>(const double& value, const PrintContext& ctx) {
+            const auto custom_format = std::ios::floatfield | std::ios::showpoint | std::ios::showpos | std::ios::uppercase;
+            if ((ctx.out.flags() & custom_format) == 0) {
+                char buffer[64];
+                const auto result = std::to_chars(std::begin(buffer), std::end(buffer), value, std::chars_format::general,
+                                                  static_cast<int>(ctx.out.precision()));
+                if (result.ec == std::errc()) {
+                    ctx.out.write(buffer, result.ptr - buffer);
+                    return;
+                }
+            }
+            ctx.out << value;
+        }
+
         template <>
         void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
             ctx.out << "null"sv;
@@ -419,7 +515,11 @@ template <>
     }
 
     Document Load(std::istream& input) {
-        return Document{LoadNode(input)};
+        return Document{detail::Parser(input).LoadNode()};
+    }
+
+    Document Load(std::string_view input) {
+        return Document{detail::Parser(input).LoadNode()};
     }
 
     void Print(const Document& doc, std::ostream& output) {
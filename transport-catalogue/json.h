@@ -1,17 +1,67 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
-#include <map>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <variant>
 #include <vector>
 
 namespace json {
 
     class Node;
-    using Dict = std::map<std::string, Node>;
     using Array = std::vector<Node>;
 
+    // Entries sorted by key in one vector: a lookup is a binary search over adjacent keys, and a dict
+    // costs a single allocation instead of a tree node per entry. Offers the part of the std::map
+    // interface in use; keys must not be changed through iterators.
+    class Dict {
+    public:
+        using value_type = std::pair<std::string, Node>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        iterator begin();
+        iterator end();
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        size_t size() const;
+        bool empty() const;
+        void reserve(size_t count);
+        void clear();
+
+        iterator lower_bound(std::string_view key);
+        const_iterator lower_bound(std::string_view key) const;
+        iterator find(std::string_view key);
+        const_iterator find(std::string_view key) const;
+        size_t count(std::string_view key) const;
+        // throws std::out_of_range for a missing key
+        Node& at(std::string_view key);
+        const Node& at(std::string_view key) const;
+        Node& operator[](std::string key);
+
+        template <typename Key, typename... Args>
+        std::pair<iterator, bool> emplace(Key&& key, Args&&... args);
+        // hint is where the key goes, e.g. lower_bound(key); a wrong hint only costs a search
+        template <typename Key, typename... Args>
+        iterator emplace_hint(const_iterator hint, Key&& key, Args&&... args);
+        std::pair<iterator, bool> insert(value_type entry);
+
+        size_t erase(std::string_view key);
+        iterator erase(const_iterator position);
+
+        bool operator==(const Dict& rhs) const;
+        bool operator!=(const Dict& rhs) const;
+
+    private:
+        std::vector<value_type> entries_;
+    };
+
     class ParsingError : public std::runtime_error {
     public:
         using runtime_error::runtime_error;
@@ -55,6 +105,129 @@ namespace json {
         return !(lhs == rhs);
     }
 
+    inline Dict::iterator Dict::begin() {
+        return entries_.begin();
+    }
+
+    inline Dict::iterator Dict::end() {
+        return entries_.end();
+    }
+
+    inline Dict::const_iterator Dict::begin() const {
+        return entries_.begin();
+    }
+
+    inline Dict::const_iterator Dict::end() const {
+        return entries_.end();
+    }
+
+    inline size_t Dict::size() const {
+        return entries_.size();
+    }
+
+    inline bool Dict::empty() const {
+        return entries_.empty();
+    }
+
+    inline void Dict::reserve(size_t count) {
+        entries_.reserve(count);
+    }
+
+    inline void Dict::clear() {
+        entries_.clear();
+    }
+
+    inline Dict::iterator Dict::lower_bound(std::string_view key) {
+        return std::lower_bound(entries_.begin(), entries_.end(), key, [](const value_type& entry, std::string_view key) {
+            return std::string_view(entry.first) < key;
+        });
+    }
+
+    inline Dict::const_iterator Dict::lower_bound(std::string_view key) const {
+        return std::lower_bound(entries_.begin(), entries_.end(), key, [](const value_type& entry, std::string_view key) {
+            return std::string_view(entry.first) < key;
+        });
+    }
+
+    inline Dict::iterator Dict::find(std::string_view key) {
+        const iterator it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    inline Dict::const_iterator Dict::find(std::string_view key) const {
+        const const_iterator it = lower_bound(key);
+        return it != end() && it->first == key ? it : end();
+    }
+
+    inline size_t Dict::count(std::string_view key) const {
+        return find(key) != end() ? 1 : 0;
+    }
+
+    inline Node& Dict::at(std::string_view key) {
+        const iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("No key '" + std::string(key) + "'");
+        }
+        return it->second;
+    }
+
+    inline const Node& Dict::at(std::string_view key) const {
+        const const_iterator it = find(key);
+        if (it == end()) {
+            throw std::out_of_range("No key '" + std::string(key) + "'");
+        }
+        return it->second;
+    }
+
+    inline Node& Dict::operator[](std::string key) {
+        return emplace(std::move(key)).first->second;
+    }
+
+    template <typename Key, typename... Args>
+    std::pair<Dict::iterator, bool> Dict::emplace(Key&& key, Args&&... args) {
+        const iterator it = lower_bound(key);
+        if (it != end() && it->first == key) {
+            return {it, false};
+        }
+        return {entries_.emplace(it, std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                                 std::forward_as_tuple(std::forward<Args>(args)...)), true};
+    }
+
+    template <typename Key, typename... Args>
+    Dict::iterator Dict::emplace_hint(const_iterator hint, Key&& key, Args&&... args) {
+        const std::string_view key_view = key;
+        if ((hint != begin() && !(std::prev(hint)->first < key_view)) || (hint != end() && !(key_view < hint->first))) {
+            return emplace(std::forward<Key>(key), std::forward<Args>(args)...).first;
+        }
+        return entries_.emplace(hint, std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    inline std::pair<Dict::iterator, bool> Dict::insert(value_type entry) {
+        return emplace(std::move(entry.first), std::move(entry.second));
+    }
+
+    inline size_t Dict::erase(std::string_view key) {
+        const const_iterator it = find(key);
+        if (it == end()) {
+            return 0;
+        }
+        entries_.erase(it);
+        return 1;
+    }
+
+    inline Dict::iterator Dict::erase(const_iterator position) {
+        return entries_.erase(position);
+    }
+
+    inline bool Dict::operator==(const Dict& rhs) const {
+        return entries_ == rhs.entries_;
+    }
+
+    inline bool Dict::operator!=(const Dict& rhs) const {
+        return !(*this == rhs);
+    }
+
     class Document {
     public:
         explicit Document(Node root)
@@ -78,6 +251,7 @@ namespace json {
     }
 
     Document Load(std::istream& input);
+    Document Load(std::string_view input);
 
     void Print(const Document& doc, std::ostream& output);
 
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "json.h"
+
+#include <istream>
+#include <string>
+#include <string_view>
+
+// The reader behind json::Load, for code that builds its own values from the tokens.
+namespace json::detail {
+
+    // Reads one value, either from text already in memory or from a stream a chunk at a time.
+    // Whitespace is skipped only between tokens, and everything after the first value is ignored.
+    class Parser {
+    public:
+        explicit Parser(std::string_view input)
+            : pos_(input.data())
+            , end_(input.data() + input.size()) {
+        }
+
+        explicit Parser(std::istream& input)
+            : input_(&input) {
+        }
+
+        Node LoadNode();
+
+        // skips whitespace and takes the next character; c is left untouched at the end of input
+        bool ReadChar(char& c);
+        // gives back the character ReadChar has just taken
+        void PutBack();
+
+        // for a parser of text in memory: the text not read yet, and moving over a part of it read elsewhere
+        std::string_view GetUnread() const;
+        void Skip(size_t count);
+
+        // the grammar of containers, after their opening bracket:
+        // on_element() reads one array element, on_entry(key) one dict value;
+        // key is only valid until the next string is read
+        template <typename OnElement>
+        void ReadArray(OnElement on_element);
+        template <typename OnEntry>
+        void ReadDict(OnEntry on_entry);
+
+        // the rest of a string after its opening quote. Without escapes the result points into the input
+        // (valid until the next chunk of a stream is read), otherwise into unescaped.
+        std::string_view LoadStringView(std::string& unescaped);
+        std::string LoadString();
+        // a string, literal or number starting with first, which ReadChar has just taken
+        Node LoadScalar(char first);
+
+    private:
+        static constexpr int END = std::char_traits<char>::eof();
+        static constexpr size_t CHUNK_SIZE = 1 << 16;
+
+        // reads the next chunk of the stream after the unread part of the buffer; false if nothing came
+        bool Fill();
+        int Peek();
+        // appends the part of a string from pos_ to its closing quote
+        void ContinueString(std::string& s);
+
+        std::string LoadLiteral();
+        Node LoadArray();
+        Node LoadDict();
+        Node LoadBool();
+        Node LoadNull();
+        Node LoadNumber();
+
+        const char* pos_ = nullptr;
+        const char* end_ = nullptr;
+        std::istream* input_ = nullptr;
+        std::string buffer_;
+        // start of the number or literal being read, kept in the buffer across Fill()
+        const char* token_ = nullptr;
+        std::string key_;
+    };
+
+    template <typename OnElement>
+    void Parser::ReadArray(OnElement on_element) {
+        using namespace std::literals;
+        for (char c;;) {
+            if (!ReadChar(c)) {
+                throw ParsingError("Array parsing error"s);
+            }
+            if (c == ']') {
+                break;
+            }
+            if (c != ',') {
+                PutBack();
+            }
+            on_element();
+        }
+    }
+
+    template <typename OnEntry>
+    void Parser::ReadDict(OnEntry on_entry) {
+        using namespace std::literals;
+        for (char c;;) {
+            if (!ReadChar(c)) {
+                throw ParsingError("Dictionary parsing error"s);
+            }
+            if (c == '}') {
+                break;
+            }
+            if (c == '"') {
+                std::string_view key = LoadStringView(key_);
+                if (input_ != nullptr && key.data() != key_.data()) {
+                    // the buffer may move while looking for ':'
+                    key = key_.assign(key);
+                }
+                if (ReadChar(c) && c == ':') {
+                    on_entry(key);
+                } else {
+                    throw ParsingError(": is expected but '"s + c + "' has been found"s);
+                }
+            } else if (c != ',') {
+                throw ParsingError(R"(',' is expected but ')"s + c + "' has been found"s);
+            }
+        }
+    }
+
+}
@@ -1,4 +1,12 @@
 #include "json_reader.h"
+#include "json_scan.h"
+#include "json_schema.h"
+
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <optional>
+#include <variant>
 
 using namespace std::literals;
 
@@ -17,7 +25,7 @@ json::Node Generate_Error_Message_Dict(int id) {
         .Build();
 }
 
-json::Array GetAnswer(std::deque<Stat> queries, RequestHandler requestHandler) {
+json::Array GetAnswer(const std::deque<Stat>& queries, const RequestHandler& requestHandler) {
     json::Array array;
     for (const auto& request: queries) {
         switch (request.type)
@@ -33,7 +41,31 @@ json::Array GetAnswer(std::deque<Stat> queries, RequestHandler requestHandler) {
             break;
         case RequestType::MAP:
             array.push_back(std::move(GetTransportMap(request, requestHandler)));
-            break;                    
+            break;
+        case RequestType::SEGMENT:
+            array.push_back(std::move(GetSegmentInfo(request, requestHandler)));
+            break;
+        case RequestType::NEAREST_STOPS:
+            array.push_back(std::move(GetNearestStopsInfo(request, requestHandler)));
+            break;
+        case RequestType::STOPS_IN_BOX:
+            array.push_back(std::move(GetStopsInBoxInfo(request, requestHandler)));
+            break;
+        case RequestType::NETWORK_SUMMARY:
+            array.push_back(std::move(GetNetworkSummaryInfo(request, requestHandler)));
+            break;
+        case RequestType::LONGEST_ROUTES:
+            array.push_back(std::move(GetLongestRoutesInfo(request, requestHandler)));
+            break;
+        case RequestType::CURVATURE_DISTRIBUTION:
+            array.push_back(std::move(GetCurvatureDistributionInfo(request, requestHandler)));
+            break;
+        case RequestType::NAME_SEARCH:
+            array.push_back(std::move(GetNameSearchInfo(request, requestHandler)));
+            break;
+        case RequestType::COMPONENTS:
+            array.push_back(std::move(GetComponentsInfo(request, requestHandler)));
+            break;
         default:
             break;
         }
@@ -62,8 +94,8 @@ json::Node GetBusesList(const Stat& stat, const RequestHandler& rh) {
 
     if (!stop_info.notFound) {
         json::Array buses;
-        for (const auto& bus : stop_info.buses)
-            buses.push_back(std::string(bus));
+        for (const Bus* bus : stop_info.buses)
+            buses.push_back(std::string(bus->name));
         
         return json::Builder()
             .StartDict()
@@ -101,12 +133,242 @@ json::Node GetBusInfo(const Stat& stat, const RequestHandler& rh) {
     }
 }
 
+json::Node GetSegmentInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto from_it = stat.key_numbers.find("from"s);
+    const auto to_it = stat.key_numbers.find("to"s);
+    if (from_it == stat.key_numbers.end() || to_it == stat.key_numbers.end() || from_it->second < 0 || to_it->second < 0) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    const std::optional<SegmentStat> segment = rh.GetSegment(stat.key_values.at("name"s),
+                                                             static_cast<size_t>(from_it->second),
+                                                             static_cast<size_t>(to_it->second));
+
+    if (segment) {
+        return json::Builder()
+            .StartDict()
+            .Key("gps_length"s)
+            .Value(segment->gps_length)
+            .Key("request_id"s)
+            .Value(stat.id)
+            .Key("route_length"s)
+            .Value(segment->route_length)
+            .EndDict()
+            .Build();
+    } else {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+}
+
+json::Node GetNearestStopsInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto lat_it = stat.key_numbers.find("latitude"s);
+    const auto lng_it = stat.key_numbers.find("longitude"s);
+    const auto count_it = stat.key_numbers.find("count"s);
+    if (lat_it == stat.key_numbers.end() || lng_it == stat.key_numbers.end() || count_it == stat.key_numbers.end() || count_it->second < 0) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    json::Array stops;
+    for (const auto& [stop, distance] : rh.GetNearestStops({lat_it->second, lng_it->second}, static_cast<size_t>(count_it->second))) {
+        stops.push_back(json::Builder()
+            .StartDict()
+            .Key("distance"s)
+            .Value(distance)
+            .Key("name"s)
+            .Value(std::string(stop->name))
+            .EndDict()
+            .Build());
+    }
+
+    return json::Builder()
+        .StartDict()
+        .Key("request_id"s)
+        .Value(stat.id)
+        .Key("stops"s)
+        .Value(std::move(stops))
+        .EndDict()
+        .Build();
+}
+
+json::Node GetStopsInBoxInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto& numbers = stat.key_numbers;
+    if (!numbers.count("min_latitude"s) || !numbers.count("min_longitude"s)
+        || !numbers.count("max_latitude"s) || !numbers.count("max_longitude"s)) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    json::Array stops;
+    for (const Stop* stop : rh.GetStopsInBox({numbers.at("min_latitude"s), numbers.at("min_longitude"s)},
+                                             {numbers.at("max_latitude"s), numbers.at("max_longitude"s)})) {
+        stops.push_back(std::string(stop->name));
+    }
+
+    return json::Builder()
+        .StartDict()
+        .Key("request_id"s)
+        .Value(stat.id)
+        .Key("stops"s)
+        .Value(std::move(stops))
+        .EndDict()
+        .Build();
+}
+
+json::Node GetNetworkSummaryInfo(const Stat& stat, const RequestHandler& rh) {
+    const NetworkSummary summary = rh.GetNetworkSummary();
+
+    return json::Builder()
+        .StartDict()
+        .Key("average_curvature"s)
+        .Value(summary.average_curvature)
+        .Key("average_route_length"s)
+        .Value(summary.average_length)
+        .Key("bus_count"s)
+        .Value(summary.buses_count)
+        .Key("max_latitude"s)
+        .Value(summary.max.lat)
+        .Key("max_longitude"s)
+        .Value(summary.max.lng)
+        .Key("min_latitude"s)
+        .Value(summary.min.lat)
+        .Key("min_longitude"s)
+        .Value(summary.min.lng)
+        .Key("request_id"s)
+        .Value(stat.id)
+        .Key("roundtrip_bus_count"s)
+        .Value(summary.roundtrip_buses_count)
+        .Key("route_stop_count"s)
+        .Value(static_cast<double>(summary.route_stops_count))
+        .Key("served_stop_count"s)
+        .Value(summary.served_stops_count)
+        .Key("stop_count"s)
+        .Value(summary.stops_count)
+        .Key("total_route_length"s)
+        .Value(summary.total_length)
+        .EndDict()
+        .Build();
+}
+
+json::Node GetLongestRoutesInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto count_it = stat.key_numbers.find("count"s);
+    if (count_it == stat.key_numbers.end() || count_it->second < 0) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    json::Array buses;
+    for (const auto& [bus_name, length] : rh.GetLongestRoutes(static_cast<size_t>(count_it->second))) {
+        buses.push_back(json::Builder()
+            .StartDict()
+            .Key("name"s)
+            .Value(std::string(bus_name))
+            .Key("route_length"s)
+            .Value(length)
+            .EndDict()
+            .Build());
+    }
+
+    return json::Builder()
+        .StartDict()
+        .Key("buses"s)
+        .Value(std::move(buses))
+        .Key("request_id"s)
+        .Value(stat.id)
+        .EndDict()
+        .Build();
+}
+
+json::Node GetCurvatureDistributionInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto buckets_it = stat.key_numbers.find("buckets"s);
+    if (buckets_it == stat.key_numbers.end() || buckets_it->second < 1) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    const CurvatureDistribution distribution = rh.GetCurvatureDistribution(static_cast<size_t>(buckets_it->second));
+    json::Array counts;
+    for (int count : distribution.counts) {
+        counts.push_back(count);
+    }
+
+    return json::Builder()
+        .StartDict()
+        .Key("counts"s)
+        .Value(std::move(counts))
+        .Key("max"s)
+        .Value(distribution.max)
+        .Key("min"s)
+        .Value(distribution.min)
+        .Key("request_id"s)
+        .Value(stat.id)
+        .EndDict()
+        .Build();
+}
+
+json::Node GetNameSearchInfo(const Stat& stat, const RequestHandler& rh) {
+    const auto count_it = stat.key_numbers.find("count"s);
+    if (count_it != stat.key_numbers.end() && count_it->second < 0) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+    const size_t count = count_it != stat.key_numbers.end() ? static_cast<size_t>(count_it->second) : 10;
+    const bool fuzzy = stat.key_numbers.count("fuzzy"s) == 0 || stat.key_numbers.at("fuzzy"s) != 0.0;
+
+    const auto matches = rh.SearchNames(stat.key_values.at("kind"s), stat.key_values.at("query"s), count, fuzzy);
+    if (!matches) {
+        return Generate_Error_Message_Dict(stat.id);
+    }
+
+    json::Array array;
+    for (const auto& [name, distance] : *matches) {
+        array.push_back(json::Builder()
+            .StartDict()
+            .Key("distance"s)
+            .Value(distance)
+            .Key("name"s)
+            .Value(std::string(name))
+            .EndDict()
+            .Build());
+    }
+
+    return json::Builder()
+        .StartDict()
+        .Key("matches"s)
+        .Value(std::move(array))
+        .Key("request_id"s)
+        .Value(stat.id)
+        .EndDict()
+        .Build();
+}
+
+json::Node GetComponentsInfo(const Stat& stat, const RequestHandler& rh) {
+    const ComponentStat components = rh.GetComponentStat();
+    return json::Builder()
+        .StartDict()
+        .Key("isolated_stop_count"s)
+        .Value(components.isolated_count)
+        .Key("largest_strong_component"s)
+        .Value(components.largest_strong_size)
+        .Key("largest_weak_component"s)
+        .Value(components.largest_weak_size)
+        .Key("request_id"s)
+        .Value(stat.id)
+        .Key("strong_component_count"s)
+        .Value(components.strong_count)
+        .Key("weak_component_count"s)
+        .Value(components.weak_count)
+        .EndDict()
+        .Build();
+}
+
 json::Node GetRouteInfo(const Stat& stat, const RequestHandler& rh) {
 
-    std::string from = stat.key_values.at("from");
-    std::string to = stat.key_values.at("to");
+    std::optional<RouteStat> route_stat_opt;
+    if (stat.key_numbers.count("from_latitude"s)) {
+        route_stat_opt = rh.GetRoute(geo::Coordinates{stat.key_numbers.at("from_latitude"s), stat.key_numbers.at("from_longitude"s)},
+                                     geo::Coordinates{stat.key_numbers.at("to_latitude"s), stat.key_numbers.at("to_longitude"s)});
+    } else {
+        std::string from = stat.key_values.at("from");
+        std::string to = stat.key_values.at("to");
 
-    std::optional<RouteStat> route_stat_opt = rh.GetRoute(from, to);
+        route_stat_opt = rh.GetRoute(from, to);
+    }
 
     if (route_stat_opt != std::nullopt) {
         json::Array array;
@@ -132,6 +394,22 @@ json::Node GetRouteInfo(const Stat& stat, const RequestHandler& rh) {
 
                 array.push_back(std::move(dict));
             }
+
+            if (item.type == "Walk"s) {
+                json::Dict dict;
+
+                dict.emplace("type"s, "Walk"s);
+                if (!item.stop_name.empty()) {
+                    dict.emplace("from"s, item.stop_name);
+                }
+                if (!item.stop_to.empty()) {
+                    dict.emplace("to"s, item.stop_to);
+                }
+                dict.emplace("distance"s, item.distance);
+                dict.emplace("time"s, item.time);
+
+                array.push_back(std::move(dict));
+            }
         }
         
         return json::Builder()
@@ -149,62 +427,41 @@ json::Node GetRouteInfo(const Stat& stat, const RequestHandler& rh) {
     }
 }
 
-DBQueries ParseJson(const json::Document& document) {
-
-    DBQueries result;
-
-    const auto root_dict = document.GetRoot().AsDict();
-
-    const auto& base_requests = root_dict.find("base_requests"s);
-    const auto& render_settings = root_dict.find("render_settings"s);
-    const auto& stat_requests = root_dict.find("stat_requests"s);
-    const auto& routing_settings = root_dict.find("routing_settings"s);
-
-    
-    //read base_requests
-    if (base_requests != root_dict.end()) {
-
-        for (const auto& it : base_requests->second.AsArray()) {
-            
-            const auto& entry_dict = it.AsDict();
-            const auto query_type_it = entry_dict.find("type"s);
+namespace {
+    void ReadBaseRequest(const json::Dict& entry_dict, DBQueries& result) {
+        const auto query_type_it = entry_dict.find("type"s);
+        
+        if (query_type_it != entry_dict.end()) {
+            const auto& type_name = query_type_it->second.AsString();
             
-            if (query_type_it != entry_dict.end()) {
-                const auto& type_name = query_type_it->second.AsString();
+            if (type_name == "Bus"s) {
+                Bus bus;
+                bus.name = result.names.Intern(entry_dict.at("name"s).AsString());
                 
-                if (type_name == "Bus"s) {
-                    Bus bus;
-                    bus.name = entry_dict.at("name"s).AsString();
-                    
-                    for (auto stop : entry_dict.at("stops"s).AsArray()) {
-                        bus.stops.push_back(std::move(stop.AsString()));
-                    }
-                    
-                    bus.is_roundtrip = entry_dict.at("is_roundtrip"s).AsBool();
-                    result.buses.push_back(std::move(bus));
+                for (const auto& stop : entry_dict.at("stops"s).AsArray()) {
+                    bus.stops.push_back(result.names.Intern(stop.AsString()));
                 }
                 
-                if (type_name == "Stop"s) {
-                    Stop stop;
-                    stop.name = entry_dict.at("name"s).AsString();
-                    stop.position.lat = entry_dict.at("latitude"s).AsDouble();
-                    stop.position.lng = entry_dict.at("longitude"s).AsDouble();
-                    
-                    for (const auto& [stop_name, distance] : entry_dict.at("road_distances"s).AsDict()) {
-                        stop.road_distances.emplace_back(stop_name, distance.AsInt());
-                    }
-                    
-                    result.stops.push_back(std::move(stop));
+                bus.is_roundtrip = entry_dict.at("is_roundtrip"s).AsBool();
+                result.buses.push_back(std::move(bus));
+            }
+            
+            if (type_name == "Stop"s) {
+                Stop stop;
+                stop.name = result.names.Intern(entry_dict.at("name"s).AsString());
+                stop.position.lat = entry_dict.at("latitude"s).AsDouble();
+                stop.position.lng = entry_dict.at("longitude"s).AsDouble();
+                
+                for (const auto& [stop_name, distance] : entry_dict.at("road_distances"s).AsDict()) {
+                    stop.road_distances.emplace_back(result.names.Intern(stop_name), distance.AsInt());
                 }
+                
+                result.stops.push_back(std::move(stop));
             }
         }
     }
 
-    
-    //read render_settings
-    if (render_settings != root_dict.end()) {
-        const auto render_map = render_settings->second.AsDict();
-
+    void ReadRenderSettings(const json::Dict& render_map, DBQueries& result) {
         result.render_settings.width = render_map.at("width"s).AsDouble();
         result.render_settings.height = render_map.at("height"s).AsDouble();
         result.render_settings.padding = render_map.at("padding"s).AsDouble();
@@ -214,19 +471,19 @@ DBQueries ParseJson(const json::Document& document) {
 
         result.render_settings.bus_label_font_size = render_map.at("bus_label_font_size"s).AsInt();
 
-        auto bus_label_offset_arr = render_map.at("bus_label_offset"s).AsArray();
+        const auto& bus_label_offset_arr = render_map.at("bus_label_offset"s).AsArray();
         result.render_settings.bus_label_offset = {bus_label_offset_arr[0].AsDouble(), bus_label_offset_arr[1].AsDouble()};
 
         result.render_settings.stop_label_font_size = render_map.at("stop_label_font_size"s).AsInt();
 
-        auto stop_label_offset_arr = render_map.at("stop_label_offset"s).AsArray();
+        const auto& stop_label_offset_arr = render_map.at("stop_label_offset"s).AsArray();
         result.render_settings.stop_label_offset = {stop_label_offset_arr[0].AsDouble(), stop_label_offset_arr[1].AsDouble()};
 
         result.render_settings.underlayer_color = SetColor(render_map.at("underlayer_color"s));
 
         result.render_settings.underlayer_width = render_map.at("underlayer_width"s).AsDouble();
 
-        auto color_palette = render_map.at("color_palette"s).AsArray();
+        const auto& color_palette = render_map.at("color_palette"s).AsArray();
         for (const auto& it : color_palette) {
             (result.render_settings.palette).push_back(SetColor(it));
         }
@@ -234,72 +491,833 @@ DBQueries ParseJson(const json::Document& document) {
         result.render_settings.height = render_map.at("height"s).AsDouble();
     }
 
-    
-    //read stat_requests
-    if (stat_requests != root_dict.end()) {
+    // read into a StatRecord and made a Stat by AddStat, as the schema form is
+    void ReadStatRequest(const json::Dict& entry_dict, DBQueries& result);
+
+    geo::DistanceFormula ToDistanceFormula(std::string_view name) {
+        if (name == "cosines"sv) {
+            return geo::DistanceFormula::COSINES;
+        }
+        if (name == "haversine"sv) {
+            return geo::DistanceFormula::HAVERSINE;
+        }
+        throw std::invalid_argument("Unknown distance_formula '"s + std::string(name) + "'"s);
+    }
+
+    void ReadRoutingSettings(const json::Dict& routing_map, DBQueries& result) {
 
-        for (const auto& it : stat_requests->second.AsArray()) {
+        result.routing_settings.bus_wait_time = routing_map.at("bus_wait_time"s).AsInt();
 
-            const auto& entry_dict = it.AsDict();
+        int mkh = 1000;
+        int minutes = 60;
+        result.routing_settings.bus_velocity = mkh / double(minutes) * routing_map.at("bus_velocity"s).AsDouble();
 
-            Stat request;
-            request.id = entry_dict.at("id").AsInt();
-            std::string request_type = entry_dict.at("type").AsString();
+        if (const auto walk_it = routing_map.find("walk_velocity"s); walk_it != routing_map.end()) {
+            result.routing_settings.walk_velocity = mkh / double(minutes) * walk_it->second.AsDouble();
+        }
+        if (const auto candidates_it = routing_map.find("walk_stop_candidates"s); candidates_it != routing_map.end()) {
+            result.routing_settings.walk_stop_candidates = candidates_it->second.AsInt();
+        }
+        if (const auto transfer_it = routing_map.find("walk_transfer_distance"s); transfer_it != routing_map.end()) {
+            result.routing_settings.walk_transfer_distance = transfer_it->second.AsDouble();
+        }
+        if (const auto formula_it = routing_map.find("distance_formula"s); formula_it != routing_map.end()) {
+            result.routing_settings.distance_formula = ToDistanceFormula(formula_it->second.AsString());
+        }
+    }
 
-            if (request_type == "Route"s) {
-                request.type = RequestType::ROUTE;
+    DBQueries ReadSections(const json::Dict& root_dict) {
 
-                const auto from_it = entry_dict.find("from"s);
-                const auto to_it = entry_dict.find("to"s);
+        DBQueries result;
 
-                if (from_it != entry_dict.end() && to_it != entry_dict.end()) {
-                    request.key_values["from"s] = from_it->second.AsString();
-                    request.key_values["to"s] = to_it->second.AsString();
-                }
+        const auto& base_requests = root_dict.find("base_requests"s);
+        const auto& render_settings = root_dict.find("render_settings"s);
+        const auto& stat_requests = root_dict.find("stat_requests"s);
+        const auto& routing_settings = root_dict.find("routing_settings"s);
+
+        if (base_requests != root_dict.end()) {
+            for (const auto& it : base_requests->second.AsArray()) {
+                ReadBaseRequest(it.AsDict(), result);
+            }
+        }
+
+        if (render_settings != root_dict.end()) {
+            ReadRenderSettings(render_settings->second.AsDict(), result);
+        }
+
+        if (stat_requests != root_dict.end()) {
+            for (const auto& it : stat_requests->second.AsArray()) {
+                ReadStatRequest(it.AsDict(), result);
+            }
+        }
+
+        if (routing_settings != root_dict.end()) {
+            ReadRoutingSettings(routing_settings->second.AsDict(), result);
+        }
 
-                result.queries.push_back(std::move(request));
+        return result;
+    }
+}
+
+namespace {
+    using RoadDistances = std::deque<std::pair<std::string_view, int>>;
+
+    // One element of base_requests, read before it is known whether it is a Stop or a Bus:
+    // "type" may come after the other keys.
+    struct BaseRequestRecord {
+        std::optional<std::string> type;
+        std::optional<std::string_view> name;
+        std::optional<double> latitude;
+        std::optional<double> longitude;
+        std::optional<RoadDistances> road_distances;
+        std::optional<std::deque<std::string_view>> stops;
+        std::optional<bool> is_roundtrip;
+    };
+
+    struct BaseRequests {
+        std::deque<Stop> stops;
+        std::deque<Bus> buses;
+    };
+
+    struct PointRecord {
+        double latitude = 0.0;
+        double longitude = 0.0;
+    };
+
+    // "from" or "to" of a stat request: a stop name, a stop index or a point for door-to-door routes
+    struct Endpoint {
+        // stays null for a point, so AsString() and AsInt() fail on it as they would on a dict
+        json::Node scalar;
+        std::optional<PointRecord> point;
+    };
+
+    // The keys of every kind of stat request. The meaning of most of them depends on "type",
+    // so they are converted, and type-checked, only once the whole request has been read.
+    struct StatRecord {
+        int id = 0;
+        std::optional<std::string> city;
+        std::string type;
+        std::optional<Endpoint> from;
+        std::optional<Endpoint> to;
+        std::optional<json::Node> name;
+        std::optional<json::Node> latitude;
+        std::optional<json::Node> longitude;
+        std::optional<json::Node> min_latitude;
+        std::optional<json::Node> min_longitude;
+        std::optional<json::Node> max_latitude;
+        std::optional<json::Node> max_longitude;
+        std::optional<json::Node> count;
+        std::optional<json::Node> buckets;
+        std::optional<json::Node> query;
+        std::optional<json::Node> kind;
+        std::optional<json::Node> fuzzy;
+    };
+
+    struct StatRequests {
+        std::deque<Stat> queries;
+    };
+
+    // as in the input, in km/h
+    struct RoutingRecord {
+        int bus_wait_time = 0;
+        double bus_velocity = 0.0;
+        std::optional<double> walk_velocity;
+        std::optional<int> walk_stop_candidates;
+        std::optional<double> walk_transfer_distance;
+        std::optional<std::string> distance_formula;
+    };
+
+    // the root of the input, or one of its cities
+    struct SectionsRecord {
+        std::optional<std::string> name;
+        BaseRequests base_requests;
+        RenderSettings render_settings;
+        StatRequests stat_requests;
+        RoutingSettings routing_settings;
+        std::optional<std::vector<CityQueries>> cities;
+    };
+}
+
+namespace json::schema {
+    template <>
+    struct Schema<BaseRequestRecord> {
+        static constexpr auto Fields() {
+            using R = BaseRequestRecord;
+            return std::make_tuple(Optional("type", &R::type),
+                                   Optional("name", &R::name),
+                                   Optional("latitude", &R::latitude),
+                                   Optional("longitude", &R::longitude),
+                                   Optional("road_distances", &R::road_distances),
+                                   Optional("stops", &R::stops),
+                                   Optional("is_roundtrip", &R::is_roundtrip));
+        }
+    };
+
+    template <>
+    struct Schema<PointRecord> {
+        static constexpr auto Fields() {
+            return std::make_tuple(Required("latitude", &PointRecord::latitude),
+                                   Required("longitude", &PointRecord::longitude));
+        }
+    };
+
+    template <>
+    struct Schema<StatRecord> {
+        static constexpr auto Fields() {
+            using R = StatRecord;
+            return std::make_tuple(Required("id", &R::id),
+                                   Optional("city", &R::city),
+                                   Required("type", &R::type),
+                                   Optional("from", &R::from),
+                                   Optional("to", &R::to),
+                                   Optional("name", &R::name),
+                                   Optional("latitude", &R::latitude),
+                                   Optional("longitude", &R::longitude),
+                                   Optional("min_latitude", &R::min_latitude),
+                                   Optional("min_longitude", &R::min_longitude),
+                                   Optional("max_latitude", &R::max_latitude),
+                                   Optional("max_longitude", &R::max_longitude),
+                                   Optional("count", &R::count),
+                                   Optional("buckets", &R::buckets),
+                                   Optional("query", &R::query),
+                                   Optional("kind", &R::kind),
+                                   Optional("fuzzy", &R::fuzzy));
+        }
+    };
+
+    template <>
+    struct Schema<RenderSettings> {
+        static constexpr auto Fields() {
+            using R = RenderSettings;
+            return std::make_tuple(Required("width", &R::width),
+                                   Required("height", &R::height),
+                                   Required("padding", &R::padding),
+                                   Required("line_width", &R::line_width),
+                                   Required("stop_radius", &R::stop_radius),
+                                   Required("bus_label_font_size", &R::bus_label_font_size),
+                                   Required("bus_label_offset", &R::bus_label_offset),
+                                   Required("stop_label_font_size", &R::stop_label_font_size),
+                                   Required("stop_label_offset", &R::stop_label_offset),
+                                   Required("underlayer_color", &R::underlayer_color),
+                                   Required("underlayer_width", &R::underlayer_width),
+                                   Required("color_palette", &R::palette));
+        }
+    };
+
+    template <>
+    struct Schema<RoutingRecord> {
+        static constexpr auto Fields() {
+            using R = RoutingRecord;
+            return std::make_tuple(Required("bus_wait_time", &R::bus_wait_time),
+                                   Required("bus_velocity", &R::bus_velocity),
+                                   Optional("walk_velocity", &R::walk_velocity),
+                                   Optional("walk_stop_candidates", &R::walk_stop_candidates),
+                                   Optional("walk_transfer_distance", &R::walk_transfer_distance),
+                                   Optional("distance_formula", &R::distance_formula));
+        }
+    };
+
+    template <>
+    struct Schema<SectionsRecord> {
+        static constexpr auto Fields() {
+            using R = SectionsRecord;
+            return std::make_tuple(Optional("name", &R::name),
+                                   Optional("base_requests", &R::base_requests),
+                                   Optional("render_settings", &R::render_settings),
+                                   Optional("stat_requests", &R::stat_requests),
+                                   Optional("routing_settings", &R::routing_settings),
+                                   Optional("cities", &R::cities));
+        }
+    };
+}
+
+namespace {
+    template <typename T>
+    T& Require(std::optional<T>& value, std::string_view key) {
+        if (!value) {
+            throw std::out_of_range("No key '"s + std::string(key) + "'"s);
+        }
+        return *value;
+    }
+
+    void Put(BaseRequests& requests, Stop&& stop) {
+        requests.stops.push_back(std::move(stop));
+    }
+
+    void Put(BaseRequests& requests, Bus&& bus) {
+        requests.buses.push_back(std::move(bus));
+    }
+
+    void Put(BaseRequestsSink& sink, Stop&& stop) {
+        sink.AddStop(std::move(stop));
+    }
+
+    void Put(BaseRequestsSink& sink, Bus&& bus) {
+        sink.AddBus(std::move(bus));
+    }
+
+    // a part of base_requests read on a worker thread, in input order, so that a sink gets them as
+    // the serial reader would give them
+    using PartRequests = std::vector<std::variant<Stop, Bus>>;
+
+    void Put(PartRequests& requests, Stop&& stop) {
+        requests.emplace_back(std::move(stop));
+    }
+
+    void Put(PartRequests& requests, Bus&& bus) {
+        requests.emplace_back(std::move(bus));
+    }
+
+    // to BaseRequests or straight to a BaseRequestsSink
+    template <typename Requests>
+    void AddBaseRequest(BaseRequestRecord& record, Requests& requests) {
+        if (!record.type) {
+            return;
+        }
+
+        if (*record.type == "Bus"sv) {
+            Bus bus;
+            bus.name = Require(record.name, "name"sv);
+            bus.stops = std::move(Require(record.stops, "stops"sv));
+            bus.is_roundtrip = Require(record.is_roundtrip, "is_roundtrip"sv);
+            Put(requests, std::move(bus));
+        }
+
+        if (*record.type == "Stop"sv) {
+            Stop stop;
+            stop.name = Require(record.name, "name"sv);
+            stop.position.lat = Require(record.latitude, "latitude"sv);
+            stop.position.lng = Require(record.longitude, "longitude"sv);
+            stop.road_distances = std::move(Require(record.road_distances, "road_distances"sv));
+            Put(requests, std::move(stop));
+        }
+    }
+
+    struct RequestTypeName {
+        std::string_view name;
+        uint64_t hash;
+        RequestType type;
+    };
+
+    constexpr RequestTypeName MakeRequestTypeName(std::string_view name, RequestType type) {
+        return {name, json::schema::HashKey(name), type};
+    }
+
+    constexpr RequestTypeName REQUEST_TYPES[] = {
+        MakeRequestTypeName("Route", RequestType::ROUTE),
+        MakeRequestTypeName("Stop", RequestType::STOP),
+        MakeRequestTypeName("Bus", RequestType::BUS),
+        MakeRequestTypeName("Segment", RequestType::SEGMENT),
+        MakeRequestTypeName("NearestStops", RequestType::NEAREST_STOPS),
+        MakeRequestTypeName("StopsInBox", RequestType::STOPS_IN_BOX),
+        MakeRequestTypeName("NetworkSummary", RequestType::NETWORK_SUMMARY),
+        MakeRequestTypeName("LongestRoutes", RequestType::LONGEST_ROUTES),
+        MakeRequestTypeName("CurvatureDistribution", RequestType::CURVATURE_DISTRIBUTION),
+        MakeRequestTypeName("NameSearch", RequestType::NAME_SEARCH),
+        MakeRequestTypeName("Components", RequestType::COMPONENTS),
+        MakeRequestTypeName("Map", RequestType::MAP)
+    };
+
+    std::optional<RequestType> FindRequestType(std::string_view name) {
+        const uint64_t hash = json::schema::HashKey(name);
+        for (const RequestTypeName& type : REQUEST_TYPES) {
+            if (type.hash == hash && type.name == name) {
+                return type.type;
             }
+        }
+        return std::nullopt;
+    }
+
+    // the only place a stat request, read by the schema or from a Dict, becomes a Stat; unknown types are dropped
+    void AddStat(StatRecord& record, std::deque<Stat>& queries) {
+        const std::optional<RequestType> type = FindRequestType(record.type);
+        if (!type) {
+            return;
+        }
+
+        Stat request;
+        request.id = record.id;
+        request.type = *type;
+        if (record.city) {
+            request.key_values["city"s] = std::move(*record.city);
+        }
 
-            if (request_type == "Stop"s) {
-                request.type = RequestType::STOP;
-                const auto payload_it = entry_dict.find("name"s);
-                if (payload_it != entry_dict.end()) {
-                    request.key_values["name"s] = payload_it->second.AsString();
+        const auto set_number = [&request](const std::string& key, const std::optional<json::Node>& value) {
+            if (value) {
+                request.key_numbers[key] = value->AsDouble();
+            }
+        };
+
+        switch (*type) {
+            case RequestType::ROUTE:
+                if (record.from && record.to) {
+                    if (record.from->point && record.to->point) {
+                        request.key_numbers["from_latitude"s] = record.from->point->latitude;
+                        request.key_numbers["from_longitude"s] = record.from->point->longitude;
+                        request.key_numbers["to_latitude"s] = record.to->point->latitude;
+                        request.key_numbers["to_longitude"s] = record.to->point->longitude;
+                    } else {
+                        request.key_values["from"s] = record.from->scalar.AsString();
+                        request.key_values["to"s] = record.to->scalar.AsString();
+                    }
+                }
+                break;
+            case RequestType::STOP:
+                [[fallthrough]];
+            case RequestType::BUS:
+                if (record.name) {
+                    request.key_values["name"s] = record.name->AsString();
+                }
+                break;
+            case RequestType::SEGMENT:
+                request.key_values["name"s] = record.name ? record.name->AsString() : ""s;
+                if (record.from && record.to) {
+                    request.key_numbers["from"s] = record.from->scalar.AsInt();
+                    request.key_numbers["to"s] = record.to->scalar.AsInt();
                 }
+                break;
+            case RequestType::NEAREST_STOPS:
+                set_number("latitude"s, record.latitude);
+                set_number("longitude"s, record.longitude);
+                set_number("count"s, record.count);
+                break;
+            case RequestType::STOPS_IN_BOX:
+                set_number("min_latitude"s, record.min_latitude);
+                set_number("min_longitude"s, record.min_longitude);
+                set_number("max_latitude"s, record.max_latitude);
+                set_number("max_longitude"s, record.max_longitude);
+                break;
+            case RequestType::LONGEST_ROUTES:
+                if (record.count) {
+                    request.key_numbers["count"s] = record.count->AsInt();
+                }
+                break;
+            case RequestType::CURVATURE_DISTRIBUTION:
+                if (record.buckets) {
+                    request.key_numbers["buckets"s] = record.buckets->AsInt();
+                }
+                break;
+            case RequestType::NAME_SEARCH:
+                request.key_values["query"s] = record.query ? record.query->AsString() : ""s;
+                request.key_values["kind"s] = record.kind ? record.kind->AsString() : "Stop"s;
+                if (record.count) {
+                    request.key_numbers["count"s] = record.count->AsInt();
+                }
+                if (record.fuzzy) {
+                    request.key_numbers["fuzzy"s] = record.fuzzy->AsBool() ? 1.0 : 0.0;
+                }
+                break;
+            case RequestType::NETWORK_SUMMARY:
+                [[fallthrough]];
+            case RequestType::COMPONENTS:
+                [[fallthrough]];
+            case RequestType::MAP:
+                break;
+        }
+
+        queries.push_back(std::move(request));
+    }
+
+    Endpoint ReadEndpoint(const json::Node& value) {
+        Endpoint endpoint;
+        if (value.IsDict()) {
+            const auto& point = value.AsDict();
+            endpoint.point = PointRecord{point.at("latitude"sv).AsDouble(), point.at("longitude"sv).AsDouble()};
+        } else {
+            endpoint.scalar = value;
+        }
+        return endpoint;
+    }
+
+    void ReadStatRequest(const json::Dict& entry_dict, DBQueries& result) {
+        static constexpr std::pair<std::string_view, std::optional<json::Node> StatRecord::*> NODE_KEYS[] = {
+            {"name"sv, &StatRecord::name},
+            {"latitude"sv, &StatRecord::latitude},
+            {"longitude"sv, &StatRecord::longitude},
+            {"min_latitude"sv, &StatRecord::min_latitude},
+            {"min_longitude"sv, &StatRecord::min_longitude},
+            {"max_latitude"sv, &StatRecord::max_latitude},
+            {"max_longitude"sv, &StatRecord::max_longitude},
+            {"count"sv, &StatRecord::count},
+            {"buckets"sv, &StatRecord::buckets},
+            {"query"sv, &StatRecord::query},
+            {"kind"sv, &StatRecord::kind},
+            {"fuzzy"sv, &StatRecord::fuzzy}
+        };
+
+        StatRecord record;
+        record.id = entry_dict.at("id"sv).AsInt();
+        if (const auto city_it = entry_dict.find("city"sv); city_it != entry_dict.end()) {
+            record.city.emplace(city_it->second.AsString());
+        }
+        record.type = entry_dict.at("type"sv).AsString();
+        if (const auto from_it = entry_dict.find("from"sv); from_it != entry_dict.end()) {
+            record.from = ReadEndpoint(from_it->second);
+        }
+        if (const auto to_it = entry_dict.find("to"sv); to_it != entry_dict.end()) {
+            record.to = ReadEndpoint(to_it->second);
+        }
+        for (const auto& [key, member] : NODE_KEYS) {
+            if (const auto it = entry_dict.find(key); it != entry_dict.end()) {
+                record.*member = it->second;
+            }
+        }
+        AddStat(record, result.queries);
+    }
+
+    DBQueries ToQueries(SectionsRecord&& record, StringArena&& names) {
+        DBQueries queries;
+        queries.names = std::move(names);
+        queries.stops = std::move(record.base_requests.stops);
+        queries.buses = std::move(record.base_requests.buses);
+        queries.queries = std::move(record.stat_requests.queries);
+        queries.render_settings = std::move(record.render_settings);
+        queries.routing_settings = record.routing_settings;
+        return queries;
+    }
 
-                result.queries.push_back(std::move(request));
+    // Names are interned into the arena of the sections being read as soon as they are seen.
+    struct Names {
+        StringArena& arena;
+        // with a pool, base_requests of a text in memory are read on its threads
+        ThreadPool* pool = nullptr;
+        // with a sink, base_requests go there one by one instead of into the sections
+        BaseRequestsSink* sink = nullptr;
+    };
+
+    // The names in one part of base_requests read on a worker thread. They are left as views into the text
+    // (or into unescaped, for names with escapes) and interned in order once all parts are read.
+    struct PartNames {
+        std::string_view text;
+        StringArena unescaped;
+    };
+
+    std::string_view KeepName(Names& names, std::string_view name) {
+        return names.arena.Intern(name);
+    }
+
+    std::string_view KeepName(PartNames& names, std::string_view name) {
+        const std::less<const char*> before;
+        if (!before(name.data(), names.text.data()) && !before(names.text.data() + names.text.size(), name.data() + name.size())) {
+            return name;
+        }
+        return names.unescaped.Intern(name);
+    }
+}
+
+namespace json::schema {
+    template <typename Context>
+    struct ValueReader<std::string_view, Context> {
+        static void Read(detail::Parser& parser, Context& names, std::string_view& value) {
+            std::string scratch;
+            value = KeepName(names, LoadStringView(parser, scratch));
+        }
+    };
+
+    // sorted by stop name, as when read from a Dict
+    template <typename Context>
+    struct ValueReader<RoadDistances, Context> {
+        static void Read(detail::Parser& parser, Context& names, RoadDistances& distances) {
+            ExpectDict(parser);
+            parser.ReadDict([&](std::string_view key) {
+                const std::string_view stop_name = KeepName(names, key);
+                ReadValue(parser, names, distances.emplace_back(stop_name, 0).second);
+            });
+
+            std::sort(distances.begin(), distances.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first < rhs.first;
+            });
+            const auto duplicate = std::adjacent_find(distances.begin(), distances.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.first == rhs.first;
+            });
+            if (duplicate != distances.end()) {
+                throw ParsingError("Duplicate key '"s + std::string(duplicate->first) + "' have been found");
             }
+        }
+    };
+}
+
+namespace {
+    template <typename Context, typename Requests>
+    void BindBaseRequest(json::detail::Parser& parser, Context& names, Requests& requests) {
+        BaseRequestRecord record;
+        json::schema::ReadValue(parser, names, record);
+        AddBaseRequest(record, requests);
+    }
+
+    template <typename Context, typename Requests>
+    void BindBaseRequests(json::detail::Parser& parser, Context& names, Requests& requests) {
+        json::schema::ExpectArray(parser);
+        parser.ReadArray([&] {
+            BindBaseRequest(parser, names, requests);
+        });
+    }
+
+    struct BaseRequestsPart {
+        // from its separator (or from just after '[' for the first part) to the next one
+        PartNames names;
+        PartRequests requests;
+    };
+
+    // the elements in a part of the array, with the grammar of Parser::ReadArray between its brackets
+    void BindPart(BaseRequestsPart& part) {
+        json::detail::Parser parser(part.names.text);
+        for (char c; parser.ReadChar(c);) {
+            if (c != ',') {
+                parser.PutBack();
+            }
+            BindBaseRequest(parser, part.names, part.requests);
+        }
+    }
 
-            if (request_type == "Bus"s) {
-                request.type = RequestType::BUS;
-                const auto payload_it = entry_dict.find("name"s);
-                if (payload_it != entry_dict.end()) {
-                    request.key_values["name"s] = payload_it->second.AsString();
+    template <typename Requests>
+    void MergePart(BaseRequestsPart& part, Names& names, Requests& requests) {
+        for (std::variant<Stop, Bus>& request : part.requests) {
+            if (Stop* stop = std::get_if<Stop>(&request)) {
+                stop->name = names.arena.Intern(stop->name);
+                for (auto& [stop_name, distance] : stop->road_distances) {
+                    stop_name = names.arena.Intern(stop_name);
                 }
+                Put(requests, std::move(*stop));
+            } else {
+                Bus& bus = std::get<Bus>(request);
+                bus.name = names.arena.Intern(bus.name);
+                for (std::string_view& stop_name : bus.stops) {
+                    stop_name = names.arena.Intern(stop_name);
+                }
+                Put(requests, std::move(bus));
+            }
+        }
+    }
 
-                result.queries.push_back(std::move(request));
+    // Splits the array at the commas between its elements and reads the parts on the pool. Each part is
+    // put into requests as soon as it and all the parts before it are read, so the result, and the order a
+    // sink gets it in, is what BindBaseRequests would give. From a part that fails on, the rest of the array
+    // is read serially, which reports the error. Returns false, with nothing read, if the array cannot be split.
+    template <typename Requests>
+    bool BindBaseRequestsInParallel(json::detail::Parser& parser, Names& names, Requests& requests) {
+        const std::string_view unread = parser.GetUnread();
+        const char* const end = unread.data() + unread.size();
+        const char* const begin = json::scan::SkipWhitespace(unread.data(), end);
+        if (begin == end || *begin != '[') {
+            return false;
+        }
+        const std::vector<const char*> separators = json::scan::FindArraySeparators(begin, end);
+        if (separators.empty()) {
+            return false;
+        }
+
+        // a few parts of about the same size per thread, so that no thread is left with much more to do
+        const size_t part_size = static_cast<size_t>(separators.back() - begin) / (names.pool->GetThreadsCount() * 4) + 1;
+        std::deque<BaseRequestsPart> parts;
+        const char* part_begin = begin + 1;
+        for (const char* separator : separators) {
+            if (separator == separators.back() || static_cast<size_t>(separator - part_begin) >= part_size) {
+                parts.emplace_back().names.text = std::string_view(part_begin, static_cast<size_t>(separator - part_begin));
+                part_begin = separator;
             }
+        }
+
+        std::deque<std::future<void>> reads;
+        for (BaseRequestsPart& part : parts) {
+            reads.push_back(names.pool->Submit([&part] {
+                BindPart(part);
+            }));
+        }
 
-            if (request_type == "Map"s) {
-                request.type = RequestType::MAP;
-                result.queries.push_back(std::move(request));
+        // each part is let go as soon as it is merged
+        for (; !parts.empty(); parts.pop_front(), reads.pop_front()) {
+            try {
+                reads.front().get();
+            } catch (const std::exception&) {
+                // the later parts are still in use by the pool
+                for (std::future<void>& read : reads) {
+                    if (read.valid()) {
+                        read.wait();
+                    }
+                }
+                parser.Skip(static_cast<size_t>(parts.front().names.text.data() - unread.data()));
+                parser.ReadArray([&] {
+                    BindBaseRequest(parser, names, requests);
+                });
+                return true;
             }
+            MergePart(parts.front(), names, requests);
         }
+        parser.Skip(static_cast<size_t>(separators.back() + 1 - unread.data()));
+        return true;
     }
+}
 
-    
-    //read routing_settings
-    if (routing_settings != root_dict.end()) {
-        const auto routing_map = routing_settings->second.AsDict();
+namespace json::schema {
+    template <>
+    struct ValueReader<BaseRequests, Names> {
+        static void Read(detail::Parser& parser, Names& names, BaseRequests& requests) {
+            if (names.sink != nullptr) {
+                Bind(parser, names, *names.sink);
+            } else {
+                Bind(parser, names, requests);
+            }
+        }
 
-        result.routing_settings.bus_wait_time = routing_map.at("bus_wait_time"s).AsInt();
+        template <typename Requests>
+        static void Bind(detail::Parser& parser, Names& names, Requests& requests) {
+            if (names.pool == nullptr || !BindBaseRequestsInParallel(parser, names, requests)) {
+                BindBaseRequests(parser, names, requests);
+            }
+        }
+    };
 
-        int mkh = 1000;
-        int minutes = 60;
-        result.routing_settings.bus_velocity = mkh / double(minutes) * routing_map.at("bus_velocity"s).AsDouble();
+    template <>
+    struct ValueReader<Endpoint, Names> {
+        static void Read(detail::Parser& parser, Names& names, Endpoint& endpoint) {
+            char c;
+            if (!parser.ReadChar(c)) {
+                throw ParsingError("Unexpected EOF"s);
+            }
+            parser.PutBack();
+            if (c == '{') {
+                ReadValue(parser, names, endpoint.point.emplace());
+            } else {
+                endpoint.scalar = LoadScalar(parser);
+            }
+        }
+    };
+
+    template <>
+    struct ValueReader<StatRequests, Names> {
+        static void Read(detail::Parser& parser, Names& names, StatRequests& requests) {
+            ExpectArray(parser);
+            parser.ReadArray([&] {
+                StatRecord record;
+                ReadValue(parser, names, record);
+                AddStat(record, requests.queries);
+            });
+        }
+    };
+
+    template <>
+    struct ValueReader<svg::Point, Names> {
+        static void Read(detail::Parser& parser, Names& names, svg::Point& point) {
+            std::vector<double> coordinates;
+            ReadValue(parser, names, coordinates);
+            point = {coordinates.at(0), coordinates.at(1)};
+        }
+    };
+
+    // a name, [r, g, b] or [r, g, b, opacity]
+    template <>
+    struct ValueReader<svg::Color, Names> {
+        static void Read(detail::Parser& parser, Names& names, svg::Color& color) {
+            char c;
+            if (!parser.ReadChar(c)) {
+                throw ParsingError("Unexpected EOF"s);
+            }
+            parser.PutBack();
+            if (c == '"') {
+                ReadValue(parser, names, color.emplace<std::string>());
+                return;
+            }
+
+            std::vector<Node> components;
+            ReadValue(parser, names, components);
+            if (components.size() == 3) {
+                color = svg::Rgb{static_cast<uint8_t>(components.at(0).AsInt()),
+                                 static_cast<uint8_t>(components.at(1).AsInt()),
+                                 static_cast<uint8_t>(components.at(2).AsInt())};
+            } else {
+                color = svg::Rgba{static_cast<uint8_t>(components.at(0).AsInt()),
+                                  static_cast<uint8_t>(components.at(1).AsInt()),
+                                  static_cast<uint8_t>(components.at(2).AsInt()),
+                                  components.at(3).AsDouble()};
+            }
+        }
+    };
+
+    template <>
+    struct ValueReader<RoutingSettings, Names> {
+        static void Read(detail::Parser& parser, Names& names, RoutingSettings& settings) {
+            RoutingRecord record;
+            ReadValue(parser, names, record);
+
+            // km/h to metres per minute
+            const int mkh = 1000;
+            const int minutes = 60;
+            settings.bus_wait_time = record.bus_wait_time;
+            settings.bus_velocity = mkh / double(minutes) * record.bus_velocity;
+            if (record.walk_velocity) {
+                settings.walk_velocity = mkh / double(minutes) * *record.walk_velocity;
+            }
+            if (record.walk_stop_candidates) {
+                settings.walk_stop_candidates = *record.walk_stop_candidates;
+            }
+            if (record.walk_transfer_distance) {
+                settings.walk_transfer_distance = *record.walk_transfer_distance;
+            }
+            if (record.distance_formula) {
+                settings.distance_formula = ToDistanceFormula(*record.distance_formula);
+            }
+        }
+    };
+
+    // a city gets its own names, as ParseJson(city) would give it
+    template <>
+    struct ValueReader<CityQueries, Names> {
+        static void Read(detail::Parser& parser, Names& names, CityQueries& city) {
+            StringArena city_arena;
+            Names city_names{city_arena, names.pool};
+            SectionsRecord record;
+            ReadValue(parser, city_names, record);
+            city.name = std::move(Require(record.name, "name"sv));
+            city.queries = ToQueries(std::move(record), std::move(city_arena));
+        }
+    };
+}
+
+namespace {
+    DBQueries BindSections(json::detail::Parser& parser, std::optional<std::vector<CityQueries>>& cities,
+                           ThreadPool* pool, BaseRequestsSink* sink) {
+        StringArena arena;
+        Names names{arena, pool, sink};
+        SectionsRecord record;
+        json::schema::ReadValue(parser, names, record);
+        cities = std::move(record.cities);
+        return ToQueries(std::move(record), std::move(arena));
     }
+}
+
+DBQueries ParseJson(const json::Document& document) {
+    return ParseJson(document.GetRoot().AsDict());
+}
+
+DBQueries ParseJson(const json::Dict& root_dict) {
+    return ReadSections(root_dict);
+}
+
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities) {
+    json::detail::Parser parser(text);
+    return BindSections(parser, cities, nullptr, nullptr);
+}
+
+DBQueries BindJson(std::istream& input, std::optional<std::vector<CityQueries>>& cities) {
+    json::detail::Parser parser(input);
+    return BindSections(parser, cities, nullptr, nullptr);
+}
+
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink) {
+    json::detail::Parser parser(text);
+    return BindSections(parser, cities, nullptr, &sink);
+}
+
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink,
+                   ThreadPool& pool) {
+    json::detail::Parser parser(text);
+    return BindSections(parser, cities, &pool, &sink);
+}
 
-    return result;
+DBQueries BindJson(std::istream& input, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink) {
+    json::detail::Parser parser(input);
+    return BindSections(parser, cities, nullptr, &sink);
 }
 
 svg::Color SetColor(const json::Node& color) {
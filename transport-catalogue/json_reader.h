@@ -4,10 +4,13 @@
 #include "json_builder.h"
 #include "map_renderer.h"
 #include "request_handler.h"
+#include "string_arena.h"
+#include "thread_pool.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 
 struct DBQueries {
+    StringArena names;
     std::deque<Stop> stops;
     std::deque<Bus> buses;
     std::deque<Stat> queries;
@@ -18,13 +21,53 @@ struct DBQueries {
 
 json::Document LoadJSON(std::istream& input);
 DBQueries ParseJson(const json::Document& document);
+// the same for one section of a document, e.g. one city
+DBQueries ParseJson(const json::Dict& root_dict);
+
+// one city of a multi-city input: {"name": .., "base_requests": .., ..}
+struct CityQueries {
+    std::string name;
+    DBQueries queries;
+};
+
+// The same as ParseJson, read straight from the text into Stops, Buses, Stats and settings through
+// the schema in json_reader.cpp, with no json::Node in between. The "cities" of a multi-city input
+// go to cities, which is left empty for an input without them.
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities);
+DBQueries BindJson(std::istream& input, std::optional<std::vector<CityQueries>>& cities);
+
+// Gets the top-level base_requests of BindJson one at a time, as soon as each one is read, in input order.
+// Their names are interned into the DBQueries being read and stay valid for as long as it lives.
+class BaseRequestsSink {
+public:
+    virtual ~BaseRequestsSink() = default;
+
+    virtual void AddStop(Stop&& stop) = 0;
+    virtual void AddBus(Bus&& bus) = 0;
+};
+
+// the same with base_requests passed to sink and left out of the result
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink);
+DBQueries BindJson(std::istream& input, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink);
+// and with base_requests split into parts read on the pool's threads, each passed to sink in order once it is read
+DBQueries BindJson(std::string_view text, std::optional<std::vector<CityQueries>>& cities, BaseRequestsSink& sink,
+                   ThreadPool& pool);
 
 svg::Color SetColor(const json::Node& node);
 
 json::Node Generate_Error_Message(int id, std::string_view text);
+json::Node Generate_Error_Message_Dict(int id);
 
-json::Array GetAnswer(std::deque<Stat> queries, RequestHandler requestHandler);
+json::Array GetAnswer(const std::deque<Stat>& queries, const RequestHandler& requestHandler);
 json::Node GetTransportMap(const Stat& stat, const RequestHandler& rh);
 json::Node GetBusesList(const Stat& stat, const RequestHandler& rh);
 json::Node GetBusInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetSegmentInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetNearestStopsInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetStopsInBoxInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetNetworkSummaryInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetLongestRoutesInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetCurvatureDistributionInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetNameSearchInfo(const Stat& stat, const RequestHandler& rh);
+json::Node GetComponentsInfo(const Stat& stat, const RequestHandler& rh);
 json::Node GetRouteInfo(const Stat& stat, const RequestHandler& rh);
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "json_scan.h"
+
+#include <cstdint>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace json::scan {
+
+    namespace {
+
+        bool IsSpace(char c) {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        bool IsStringSpecial(char c) {
+            return c == '"' || c == '\\' || c == '\n' || c == '\r';
+        }
+
+        bool IsStructural(char c) {
+            return c == '"' || c == ',' || c == '[' || c == ']' || c == '{' || c == '}';
+        }
+
+        [[maybe_unused]] int FirstSet(uint32_t mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<int>(index);
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+#if defined(__AVX2__)
+
+        constexpr int BLOCK_SIZE = 32;
+        using Block = __m256i;
+
+        Block LoadBlock(const char* p) {
+            return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        }
+
+        uint32_t Equal(Block block, char c) {
+            return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(c))));
+        }
+
+        // bytes in ['\t', '\r']: subtract '\t' and compare unsigned
+        uint32_t InControlRange(Block block) {
+            const __m256i shifted = _mm256_sub_epi8(block, _mm256_set1_epi8('\t'));
+            const __m256i in_range = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8('\r' - '\t')), shifted);
+            return static_cast<uint32_t>(_mm256_movemask_epi8(in_range));
+        }
+
+#elif defined(__SSE2__)
+
+        constexpr int BLOCK_SIZE = 16;
+        using Block = __m128i;
+
+        Block LoadBlock(const char* p) {
+            return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        }
+
+        uint32_t Equal(Block block, char c) {
+            return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+        }
+
+        uint32_t InControlRange(Block block) {
+            const __m128i shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+            const __m128i in_range = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')), shifted);
+            return static_cast<uint32_t>(_mm_movemask_epi8(in_range));
+        }
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+        // bit i is set when byte i of the block is not whitespace
+        uint32_t NotSpaceMask(Block block) {
+            constexpr uint32_t ALL = BLOCK_SIZE == 32 ? UINT32_MAX : (1u << BLOCK_SIZE) - 1;
+            return ~(Equal(block, ' ') | InControlRange(block)) & ALL;
+        }
+
+        uint32_t StringSpecialMask(Block block) {
+            return Equal(block, '"') | Equal(block, '\\') | Equal(block, '\n') | Equal(block, '\r');
+        }
+
+        uint32_t StructuralMask(Block block) {
+            return Equal(block, '"') | Equal(block, ',') | Equal(block, '[') | Equal(block, ']')
+                 | Equal(block, '{') | Equal(block, '}');
+        }
+
+#endif
+
+    }
+
+    const char* SkipWhitespace(const char* begin, const char* end) {
+        // between tokens there is usually nothing or a single space
+        if (begin != end && !IsSpace(*begin)) {
+            return begin;
+        }
+#if defined(__AVX2__) || defined(__SSE2__)
+        for (; end - begin >= BLOCK_SIZE; begin += BLOCK_SIZE) {
+            if (const uint32_t mask = NotSpaceMask(LoadBlock(begin)); mask != 0) {
+                return begin + FirstSet(mask);
+            }
+        }
+#endif
+        while (begin != end && IsSpace(*begin)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    const char* FindStringSpecial(const char* begin, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+        for (; end - begin >= BLOCK_SIZE; begin += BLOCK_SIZE) {
+            if (const uint32_t mask = StringSpecialMask(LoadBlock(begin)); mask != 0) {
+                return begin + FirstSet(mask);
+            }
+        }
+#endif
+        while (begin != end && !IsStringSpecial(*begin)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+
+    const char* FindStructural(const char* begin, const char* end) {
+#if defined(__AVX2__) || defined(__SSE2__)
+        for (; end - begin >= BLOCK_SIZE; begin += BLOCK_SIZE) {
+            if (const uint32_t mask = StructuralMask(LoadBlock(begin)); mask != 0) {
+                return begin + FirstSet(mask);
+            }
+        }
+#endif
+        while (begin != end && !IsStructural(*begin)) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    std::vector<const char*> FindArraySeparators(const char* begin, const char* end) {
+        std::vector<const char*> separators;
+        // closing brackets of the open containers
+        std::vector<char> open;
+        for (const char* pos = begin; (pos = FindStructural(pos, end)) != end; ++pos) {
+            switch (*pos) {
+                case '"':
+                    for (++pos; (pos = FindStringSpecial(pos, end)) != end && *pos != '"'; ++pos) {
+                        if (*pos == '\\' && ++pos == end) {
+                            break;
+                        }
+                    }
+                    if (pos == end) {
+                        return {};
+                    }
+                    break;
+                case '[':
+                    open.push_back(']');
+                    break;
+                case '{':
+                    open.push_back('}');
+                    break;
+                case ',':
+                    if (open.size() == 1) {
+                        separators.push_back(pos);
+                    }
+                    break;
+                default:
+                    if (open.empty() || open.back() != *pos) {
+                        return {};
+                    }
+                    open.pop_back();
+                    if (open.empty()) {
+                        separators.push_back(pos);
+                        return separators;
+                    }
+            }
+        }
+        return {};
+    }
+
+}
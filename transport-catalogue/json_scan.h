@@ -0,0 +1,22 @@
+#pragma once
+
+#include <vector>
+
+// Character classes the JSON parser skips over, tested 32 (AVX2) or 16 (SSE2) bytes at a time.
+// Without either instruction set the same functions fall back to plain loops.
+namespace json::scan {
+
+    // first character in [begin, end) that std::isspace would not skip, end if none
+    const char* SkipWhitespace(const char* begin, const char* end);
+
+    // first '"', '\\', '\n' or '\r' in [begin, end), end if none: the characters a run inside a string stops at
+    const char* FindStringSpecial(const char* begin, const char* end);
+
+    // first '"', ',', '[', ']', '{' or '}' in [begin, end), end if none: what matters for nesting outside strings
+    const char* FindStructural(const char* begin, const char* end);
+
+    // The commas between the elements of the array whose '[' is at begin, then its closing ']'.
+    // Empty if the brackets do not match or a string is not closed before end; nothing else is checked.
+    std::vector<const char*> FindArraySeparators(const char* begin, const char* end);
+
+}
@@ -0,0 +1,74 @@
+#include "json_schema.h"
+
+namespace json::schema {
+
+    using namespace std::literals;
+
+    namespace {
+
+        char ReadOpening(detail::Parser& parser) {
+            char c;
+            if (!parser.ReadChar(c)) {
+                throw ParsingError("Unexpected EOF"s);
+            }
+            return c;
+        }
+
+        // the value that has just been found not to be of the expected type, for its As*() to throw
+        Node LoadUnexpected(detail::Parser& parser) {
+            parser.PutBack();
+            return parser.LoadNode();
+        }
+
+    }
+
+    void ExpectDict(detail::Parser& parser) {
+        if (ReadOpening(parser) != '{') {
+            LoadUnexpected(parser).AsDict();
+        }
+    }
+
+    void ExpectArray(detail::Parser& parser) {
+        if (ReadOpening(parser) != '[') {
+            LoadUnexpected(parser).AsArray();
+        }
+    }
+
+    std::string_view LoadStringView(detail::Parser& parser, std::string& scratch) {
+        if (ReadOpening(parser) != '"') {
+            LoadUnexpected(parser).AsString();
+        }
+        return parser.LoadStringView(scratch);
+    }
+
+    Node LoadScalar(detail::Parser& parser) {
+        const char c = ReadOpening(parser);
+        if (c == '[' || c == '{') {
+            return LoadUnexpected(parser);
+        }
+        return parser.LoadScalar(c);
+    }
+
+    void SkipValue(detail::Parser& parser) {
+        switch (const char c = ReadOpening(parser)) {
+            case '[':
+                parser.ReadArray([&parser] {
+                    SkipValue(parser);
+                });
+                break;
+            case '{':
+                parser.ReadDict([&parser](std::string_view) {
+                    SkipValue(parser);
+                });
+                break;
+            case '"': {
+                std::string scratch;
+                parser.LoadStringView(scratch);
+                break;
+            }
+            default:
+                parser.LoadScalar(c);
+        }
+    }
+
+}
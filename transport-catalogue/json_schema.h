@@ -0,0 +1,215 @@
+#pragma once
+
+#include "json.h"
+#include "json_parser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Reads JSON straight into C++ structs, without building Nodes for them. A struct read from a dict
+// lists its keys in a Schema; keys are hashed at compile time, so a key of the input is matched with
+// one hash and, on a hit, one comparison.
+namespace json::schema {
+
+    // FNV-1a
+    constexpr uint64_t HashKey(std::string_view key) {
+        uint64_t hash = 14695981039346656037ull;
+        for (const char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    template <typename Record, typename T>
+    struct Field {
+        std::string_view key;
+        uint64_t hash;
+        T Record::* member;
+        // a missing required key throws the std::out_of_range of Dict::at
+        bool required;
+    };
+
+    template <typename Record, typename T>
+    constexpr Field<Record, T> Required(std::string_view key, T Record::* member) {
+        return {key, HashKey(key), member, true};
+    }
+
+    template <typename Record, typename T>
+    constexpr Field<Record, T> Optional(std::string_view key, T Record::* member) {
+        return {key, HashKey(key), member, false};
+    }
+
+    // Specialized for every struct read from a dict, with
+    //     static constexpr auto Fields() { return std::make_tuple(Required("key", &Record::member), ...); }
+    // Keys the schema does not list are skipped.
+    template <typename Record>
+    struct Schema;
+
+    // Type errors throw what Node::As*() would for the same value, so the input can be checked
+    // as if it had been loaded into a Document first.
+    void ExpectDict(detail::Parser& parser);
+    void ExpectArray(detail::Parser& parser);
+    // a string: a view into the input or into scratch, see Parser::LoadStringView
+    std::string_view LoadStringView(detail::Parser& parser, std::string& scratch);
+    // a null, bool, number or string; any other value is loaded whole, for its As*() to report
+    Node LoadScalar(detail::Parser& parser);
+    void SkipValue(detail::Parser& parser);
+
+    template <typename Record, typename Context>
+    void ReadRecord(detail::Parser& parser, Context& context, Record& record);
+
+    // How a T is read. Context goes down to every value, e.g. a StringArena to intern names into.
+    // Unless specialized, a T is a dict described by Schema<T>.
+    template <typename T, typename Context>
+    struct ValueReader {
+        static void Read(detail::Parser& parser, Context& context, T& value) {
+            ReadRecord(parser, context, value);
+        }
+    };
+
+    template <typename T, typename Context>
+    void ReadValue(detail::Parser& parser, Context& context, T& value) {
+        ValueReader<T, Context>::Read(parser, context, value);
+    }
+
+    template <typename Context>
+    struct ValueReader<int, Context> {
+        static void Read(detail::Parser& parser, Context&, int& value) {
+            value = LoadScalar(parser).AsInt();
+        }
+    };
+
+    template <typename Context>
+    struct ValueReader<double, Context> {
+        static void Read(detail::Parser& parser, Context&, double& value) {
+            value = LoadScalar(parser).AsDouble();
+        }
+    };
+
+    template <typename Context>
+    struct ValueReader<bool, Context> {
+        static void Read(detail::Parser& parser, Context&, bool& value) {
+            value = LoadScalar(parser).AsBool();
+        }
+    };
+
+    template <typename Context>
+    struct ValueReader<std::string, Context> {
+        static void Read(detail::Parser& parser, Context&, std::string& value) {
+            std::string scratch;
+            value = LoadStringView(parser, scratch);
+        }
+    };
+
+    // left unconverted, for a value whose type depends on other keys
+    template <typename Context>
+    struct ValueReader<Node, Context> {
+        static void Read(detail::Parser& parser, Context&, Node& value) {
+            value = LoadScalar(parser);
+        }
+    };
+
+    template <typename T, typename Context>
+    struct ValueReader<std::optional<T>, Context> {
+        static void Read(detail::Parser& parser, Context& context, std::optional<T>& value) {
+            ReadValue(parser, context, value.emplace());
+        }
+    };
+
+    template <typename T, typename Context>
+    struct ValueReader<std::vector<T>, Context> {
+        static void Read(detail::Parser& parser, Context& context, std::vector<T>& value) {
+            ExpectArray(parser);
+            parser.ReadArray([&] {
+                ReadValue(parser, context, value.emplace_back());
+            });
+        }
+    };
+
+    template <typename T, typename Context>
+    struct ValueReader<std::deque<T>, Context> {
+        static void Read(detail::Parser& parser, Context& context, std::deque<T>& value) {
+            ExpectArray(parser);
+            parser.ReadArray([&] {
+                ReadValue(parser, context, value.emplace_back());
+            });
+        }
+    };
+
+    namespace impl {
+
+        template <typename Fields, size_t... I>
+        constexpr bool HasDistinctHashes(const Fields& fields, std::index_sequence<I...>) {
+            const uint64_t hashes[] = {std::get<I>(fields).hash...};
+            for (size_t i = 0; i < sizeof...(I); ++i) {
+                for (size_t j = i + 1; j < sizeof...(I); ++j) {
+                    if (hashes[i] == hashes[j]) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        template <size_t I, typename Record, typename Context>
+        void ReadField(detail::Parser& parser, Context& context, Record& record, std::string_view key, uint64_t& seen) {
+            using namespace std::literals;
+            constexpr auto field = std::get<I>(Schema<Record>::Fields());
+            if ((seen & (uint64_t{1} << I)) != 0) {
+                throw ParsingError("Duplicate key '"s + std::string(key) + "' have been found");
+            }
+            seen |= uint64_t{1} << I;
+            ReadValue(parser, context, record.*field.member);
+        }
+
+        // false for a key the schema does not list
+        template <typename Record, typename Context, size_t... I>
+        bool ReadFields(detail::Parser& parser, Context& context, Record& record, std::string_view key, uint64_t& seen,
+                        std::index_sequence<I...>) {
+            constexpr auto fields = Schema<Record>::Fields();
+            const uint64_t hash = HashKey(key);
+            return ((hash == std::get<I>(fields).hash && key == std::get<I>(fields).key
+                     && (ReadField<I>(parser, context, record, key, seen), true)) || ...);
+        }
+
+        // the first missing key in the order of the schema, as a run of Dict::at() calls would find it
+        template <typename Record, size_t... I>
+        void CheckRequired(uint64_t seen, std::index_sequence<I...>) {
+            constexpr auto fields = Schema<Record>::Fields();
+            const bool missing[] = {(std::get<I>(fields).required && (seen & (uint64_t{1} << I)) == 0)...};
+            const std::string_view keys[] = {std::get<I>(fields).key...};
+            for (size_t i = 0; i < sizeof...(I); ++i) {
+                if (missing[i]) {
+                    throw std::out_of_range("No key '" + std::string(keys[i]) + "'");
+                }
+            }
+        }
+
+    }
+
+    template <typename Record, typename Context>
+    void ReadRecord(detail::Parser& parser, Context& context, Record& record) {
+        constexpr auto fields = Schema<Record>::Fields();
+        constexpr size_t count = std::tuple_size_v<decltype(fields)>;
+        static_assert(count <= 64, "a schema has at most 64 keys");
+        static_assert(impl::HasDistinctHashes(fields, std::make_index_sequence<count>()), "keys of a schema collide");
+
+        ExpectDict(parser);
+        uint64_t seen = 0;
+        parser.ReadDict([&](std::string_view key) {
+            if (!impl::ReadFields(parser, context, record, key, seen, std::make_index_sequence<count>())) {
+                SkipValue(parser);
+            }
+        });
+        impl::CheckRequired<Record>(seen, std::make_index_sequence<count>());
+    }
+
+}
@@ -1,32 +1,109 @@
-#include "graph.h"
+#include "binary_base.h"
+#include "city_catalogues.h"
 #include "json_reader.h"
-#include "map_renderer.h"
-#include "request_handler.h"
-#include "transport_router.h"
+#include "mapped_file.h"
+#include "pipelined_loader.h"
+#include "versioned_catalogue.h"
+
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
-int main() {
-    tc::TransportCatalogue transport_catalogue;
+namespace {
+    void AnswerCities(vector<CityQueries>&& cities_queries, const deque<Stat>& queries) {
+        CityCatalogues cities;
+        vector<future<void>> loads;
+        for (CityQueries& city : cities_queries) {
+            loads.push_back(cities.Load(std::move(city.name), std::move(city.queries)));
+        }
+        for (auto& load : loads) {
+            load.get();
+        }
+
+        json::Print(json::Document{ cities.Answer(queries) }, std::cout);
+    }
 
-    DBQueries dbq = ParseJson(LoadJSON(cin));
+    void AnswerSnapshot(const CatalogueSnapshot& snapshot, const deque<Stat>& queries) {
+        json::Array answer = GetAnswer(queries, snapshot.GetRequestHandler());
 
-    transport_catalogue.FillTransportBase(dbq.stops, dbq.buses);
+        json::Print(json::Document{ answer }, std::cout);
+    }
+
+    // the JSON input from the file at path, mapped and read in place, or streamed from stdin when there is none
+    DBQueries BindInput(const char* path, optional<vector<CityQueries>>& cities) {
+        if (path == nullptr) {
+            return BindJson(cin, cities);
+        }
+        const json::MappedFile file(path);
+        return BindJson(file.GetText(), cities);
+    }
+}
 
-    graph::DirectedWeightedGraph<double> routes_graph(transport_catalogue.GetAllStopsCount());
-    
-    TransportRouter transport_router(routes_graph, transport_catalogue, dbq.routing_settings);
-    transport_router.CreateGraph();
+// main [--timings] [input.json]: a file given by path is mapped and read in place, with its base_requests read in parts
+// on all cores, otherwise the input is streamed from stdin. The catalogue is filled while the input is still being parsed; --timings prints how long each stage took.
+// main --convert base.bin [input.json]: saves the stops, buses and settings of the input as a binary base.
+// main --base base.bin [input.json]: answers the stat requests of the input from a binary base;
+// the base_requests and settings of the input are not used.
+int main(int argc, char* argv[]) {
+    if (argc > 1 && (argv[1] == "--convert"sv || argv[1] == "--base"sv)) {
+        const string_view mode = argv[1];
+        if (argc < 3) {
+            cerr << "usage: " << argv[0] << ' ' << mode << " base.bin [input.json]" << endl;
+            return 2;
+        }
+        const char* const base_path = argv[2];
+        optional<vector<CityQueries>> cities;
+        const DBQueries input = BindInput(argc > 3 ? argv[3] : nullptr, cities);
 
-    graph::Router<double> router(routes_graph);
+        if (mode == "--convert"sv) {
+            ofstream output(base_path, ios::binary);
+            SaveBase(input, output);
+            return output ? 0 : 1;
+        }
 
-    MapRenderer map_renderer(dbq.render_settings);
+        const json::MappedFile file(base_path);
+        DBQueries base = LoadBase(file.GetText());
+        const CatalogueSnapshot snapshot(std::move(base.names), std::move(base.stops), std::move(base.buses),
+                                         base.render_settings, base.routing_settings);
+        AnswerSnapshot(snapshot, input.queries);
+        return 0;
+    }
 
-    RequestHandler requestHandler(transport_catalogue, map_renderer, router, transport_router);
+    const bool print_timings = argc > 1 && argv[1] == "--timings"sv;
+    if (print_timings) {
+        --argc;
+        ++argv;
+    }
 
-    json::Array answer = GetAnswer(dbq.queries, requestHandler);
+    // {"cities": [{"name": .., "base_requests": .., ..}, ..], "stat_requests": [{.., "city": ..}, ..]}
+    PipelinedLoad load;
+    if (argc > 1) {
+        const json::MappedFile file(argv[1]);
+        // a single core gains nothing from reading base_requests in parts
+        const size_t threads_count = thread::hardware_concurrency();
+        if (threads_count > 1) {
+            ThreadPool pool(threads_count);
+            load = LoadPipelined(file.GetText(), pool);
+        } else {
+            load = LoadPipelined(file.GetText());
+        }
+    } else {
+        load = LoadPipelined(cin);
+    }
+    if (print_timings) {
+        cerr << load.timings << endl;
+    }
 
-    json::Print(json::Document{ answer }, std::cout);
+    if (load.cities) {
+        AnswerCities(std::move(*load.cities), load.queries.queries);
+    } else {
+        AnswerSnapshot(*load.snapshot, load.queries.queries);
+    }
 
     return 0;
 }
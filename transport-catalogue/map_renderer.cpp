@@ -30,7 +30,7 @@ void MapRenderer::AddBusRoutes(svg::Document& doc, const std::deque<svg::Point>&
     doc.Add(std::move(line));
 }
 
-void MapRenderer::AddBusNames(svg::Document& doc, const svg::Point& pos, const std::string& name, size_t color_idx) const {
+void MapRenderer::AddBusNames(svg::Document& doc, const svg::Point& pos, std::string_view name, size_t color_idx) const {
     svg::Text text_underlayer;
     text_underlayer.SetFillColor(rs_.underlayer_color)
         .SetStrokeColor(rs_.underlayer_color)
@@ -42,7 +42,7 @@ void MapRenderer::AddBusNames(svg::Document& doc, const svg::Point& pos, const s
         .SetFontSize(static_cast<uint32_t>(rs_.bus_label_font_size))
         .SetFontFamily("Verdana")
         .SetFontWeight("bold")
-        .SetData(name);
+        .SetData(std::string(name));
     
     doc.Add(std::move(text_underlayer));
     
@@ -53,7 +53,7 @@ void MapRenderer::AddBusNames(svg::Document& doc, const svg::Point& pos, const s
         .SetFontSize(static_cast<uint32_t>(rs_.bus_label_font_size))
         .SetFontFamily("Verdana")
         .SetFontWeight("bold")
-        .SetData(name);
+        .SetData(std::string(name));
     
     doc.Add(std::move(text_name));
 }
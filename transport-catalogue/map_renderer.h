@@ -41,7 +41,7 @@ class MapRenderer {
     size_t GetColor() const;
 
     void AddBusRoutes(svg::Document& doc, const std::deque<svg::Point>& stops_points, size_t color_idx) const;
-    void AddBusNames(svg::Document& doc, const svg::Point& pos, const std::string& name, size_t color_idx) const;
+    void AddBusNames(svg::Document& doc, const svg::Point& pos, std::string_view name, size_t color_idx) const;
 
     void AddStopPoints(svg::Document& doc, const svg::Point& pos) const;
     void AddStopPoints(svg::Document& doc, const Container_stops_points& points) const;
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace json {
+
+    // Read-only contents of a file, memory-mapped where the platform allows it.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        std::string_view GetText() const;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#if defined(_WIN32)
+        std::string contents_;
+#endif
+    };
+
+}
@@ -0,0 +1,192 @@
+#include "name_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+using namespace std;
+
+namespace tc {
+
+    namespace {
+        // five names per pilot on average; the positions are spread over a few percent more than the names,
+        // so that the last buckets placed still find free positions quickly
+        constexpr size_t KEYS_PER_BUCKET = 5;
+        constexpr double LOAD_FACTOR = 0.97;
+        constexpr uint32_t PILOT_COUNT = 1u << 16;
+        constexpr int MAX_SEED_ATTEMPTS = 32;
+
+        uint64_t Mix(uint64_t x) {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+
+        uint64_t HashBytes(string_view name, uint64_t seed) {
+            uint64_t hash = seed ^ (name.size() * 0x9e3779b97f4a7c15ULL);
+            size_t pos = 0;
+            for (; pos + sizeof(uint64_t) <= name.size(); pos += sizeof(uint64_t)) {
+                uint64_t word;
+                memcpy(&word, name.data() + pos, sizeof(word));
+                hash = (hash ^ word) * 0x9fb21c651e98df25ULL;
+                hash ^= hash >> 29;
+            }
+            uint64_t tail = 0;
+            for (size_t shift = 0; pos < name.size(); ++pos, shift += 8) {
+                tail |= static_cast<uint64_t>(static_cast<unsigned char>(name[pos])) << shift;
+            }
+            return Mix(hash ^ tail ^ 0xff51afd7ed558ccdULL);
+        }
+
+        // maps a 32-bit value onto [0, range) without a division
+        size_t Reduce(uint32_t value, size_t range) {
+            return static_cast<size_t>((static_cast<uint64_t>(value) * range) >> 32);
+        }
+    }
+
+    NameIndex::KeyHash NameIndex::HashName(string_view name) const {
+        KeyHash key;
+        key.hash = HashBytes(name, seed_);
+        key.bucket = Reduce(static_cast<uint32_t>(key.hash), pilots_.size());
+        return key;
+    }
+
+    // mixed with the pilot, so that every pilot scatters the names of a bucket independently
+    size_t NameIndex::GetPosition(const KeyHash& key, uint16_t pilot) const {
+        return Reduce(static_cast<uint32_t>(Mix(key.hash + pilot * 0x9e3779b97f4a7c15ULL) >> 32), position_count_);
+    }
+
+    bool NameIndex::TryBuild(const vector<Entry>& entries) {
+        const size_t slot_count = entries.size();
+        const size_t bucket_count = (slot_count + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+        position_count_ = max(slot_count, static_cast<size_t>(slot_count / LOAD_FACTOR));
+        pilots_.assign(bucket_count, 0);
+        ids_.assign(slot_count, 0);
+        fingerprints_.assign(slot_count, 0);
+
+        vector<KeyHash> hashes;
+        hashes.reserve(slot_count);
+        vector<vector<uint32_t>> buckets(bucket_count);
+        for (size_t i = 0; i < slot_count; ++i) {
+            hashes.push_back(HashName(entries[i].first));
+            buckets[hashes.back().bucket].push_back(static_cast<uint32_t>(i));
+        }
+
+        vector<uint32_t> order(bucket_count);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&buckets](uint32_t lhs, uint32_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        vector<bool> taken(position_count_, false);
+        vector<size_t> positions;
+        vector<pair<size_t, uint32_t>> placed;
+        placed.reserve(slot_count);
+
+        for (uint32_t bucket : order) {
+            const auto& members = buckets[bucket];
+            if (members.empty()) {
+                break;
+            }
+
+            bool fits = false;
+            for (uint32_t pilot = 0; pilot < PILOT_COUNT && !fits; ++pilot) {
+                positions.clear();
+                fits = true;
+                for (uint32_t i : members) {
+                    const size_t position = GetPosition(hashes[i], static_cast<uint16_t>(pilot));
+                    if (taken[position] || find(positions.begin(), positions.end(), position) != positions.end()) {
+                        fits = false;
+                        break;
+                    }
+                    positions.push_back(position);
+                }
+                if (fits) {
+                    pilots_[bucket] = static_cast<uint16_t>(pilot);
+                }
+            }
+
+            if (!fits) {
+                return false;
+            }
+
+            for (size_t i = 0; i < members.size(); ++i) {
+                taken[positions[i]] = true;
+                placed.emplace_back(positions[i], members[i]);
+            }
+        }
+
+        // as many positions past the last slot are taken as slots below it are left free
+        remapped_.assign(position_count_ - slot_count, 0);
+        size_t free_slot = 0;
+        for (size_t position = slot_count; position < position_count_; ++position) {
+            if (taken[position]) {
+                while (taken[free_slot]) {
+                    ++free_slot;
+                }
+                remapped_[position - slot_count] = static_cast<uint32_t>(free_slot++);
+            }
+        }
+
+        for (const auto& [position, entry] : placed) {
+            const size_t slot = position < slot_count ? position : remapped_[position - slot_count];
+            ids_[slot] = static_cast<uint32_t>(entries[entry].second);
+            fingerprints_[slot] = static_cast<uint16_t>(hashes[entry].hash);
+        }
+
+        return true;
+    }
+
+    bool NameIndex::Build(const vector<Entry>& entries) {
+        Clear();
+        if (entries.empty()) {
+            return true;
+        }
+        if (entries.size() > numeric_limits<uint32_t>::max() / 2) {
+            return false;
+        }
+
+        for (int attempt = 0; attempt < MAX_SEED_ATTEMPTS; ++attempt) {
+            seed_ = Mix(0x243f6a8885a308d3ULL + static_cast<uint64_t>(attempt));
+            if (TryBuild(entries)) {
+                return true;
+            }
+        }
+
+        Clear();
+        return false;
+    }
+
+    optional<size_t> NameIndex::FindSlot(string_view name) const {
+        if (ids_.empty()) {
+            return nullopt;
+        }
+
+        const KeyHash key = HashName(name);
+        size_t slot = GetPosition(key, pilots_[key.bucket]);
+        if (slot >= ids_.size()) {
+            slot = remapped_[slot - ids_.size()];
+        }
+        if (fingerprints_[slot] != static_cast<uint16_t>(key.hash)) {
+            return nullopt;
+        }
+        return slot;
+    }
+
+    size_t NameIndex::GetSize() const {
+        return ids_.size();
+    }
+
+    void NameIndex::Clear() {
+        seed_ = 0;
+        position_count_ = 0;
+        pilots_.clear();
+        remapped_.clear();
+        ids_.clear();
+        fingerprints_.clear();
+    }
+}
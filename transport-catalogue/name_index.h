@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tc {
+
+    // Minimal perfect hash over a frozen set of names (hash and displace, with a 16-bit pilot per bucket
+    // of about five names: ~3.2 bits per name, plus the ids and 16-bit fingerprints).
+    // Every name owns exactly one id, so a lookup is one hash, a fingerprint check and one compare.
+    // The names themselves are not kept: Find gets them back by id from their owner.
+    class NameIndex {
+    public:
+        using Entry = std::pair<std::string_view, size_t>;
+
+        // names must be unique.
+        // False, with the index left empty, if no perfect hash was found: callers then look names up their own way.
+        bool Build(const std::vector<Entry>& entries);
+        // name_of(id) gives the name an id was built with
+        template <typename NameOf>
+        std::optional<size_t> Find(std::string_view name, NameOf name_of) const;
+        size_t GetSize() const;
+        void Clear();
+
+    private:
+        struct KeyHash {
+            uint64_t hash;
+            size_t bucket;
+        };
+
+        bool TryBuild(const std::vector<Entry>& entries);
+        KeyHash HashName(std::string_view name) const;
+        size_t GetPosition(const KeyHash& key, uint16_t pilot) const;
+        // the slot of a name, or nothing if its fingerprint rules it out
+        std::optional<size_t> FindSlot(std::string_view name) const;
+
+        uint64_t seed_ = 0;
+        size_t position_count_ = 0;
+        std::vector<uint16_t> pilots_;
+        // positions past the last slot are mapped onto the slots no position below it took
+        std::vector<uint32_t> remapped_;
+        std::vector<uint32_t> ids_;
+        std::vector<uint16_t> fingerprints_;
+    };
+
+    template <typename NameOf>
+    std::optional<size_t> NameIndex::Find(std::string_view name, NameOf name_of) const {
+        const std::optional<size_t> slot = FindSlot(name);
+        if (!slot || name_of(ids_[*slot]) != name) {
+            return std::nullopt;
+        }
+        return ids_[*slot];
+    }
+}
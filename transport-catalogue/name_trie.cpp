@@ -0,0 +1,178 @@
+#include "name_trie.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace tc {
+
+    namespace {
+        uint32_t CommonPrefixLength(string_view lhs, string_view rhs) {
+            const size_t length = min(lhs.size(), rhs.size());
+            size_t i = 0;
+            while (i < length && lhs[i] == rhs[i]) {
+                ++i;
+            }
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    void NameTrie::Build(vector<string_view> names) {
+        sort(names.begin(), names.end());
+        names.erase(unique(names.begin(), names.end()), names.end());
+        names_ = move(names);
+        nodes_.clear();
+        first_bytes_.clear();
+        max_length_ = 0;
+        for (string_view name : names_) {
+            max_length_ = max(max_length_, name.size());
+        }
+        if (names_.empty()) {
+            return;
+        }
+
+        Node root;
+        root.depth = CommonPrefixLength(names_.front(), names_.back());
+        root.last_name = static_cast<uint32_t>(names_.size());
+        nodes_.push_back(root);
+        first_bytes_.push_back(0);
+
+        // breadth first: the children of node i are appended together when i is expanded
+        for (uint32_t i = 0; i < nodes_.size(); ++i) {
+            const uint32_t depth = nodes_[i].depth;
+            uint32_t begin = nodes_[i].first_name;
+            const uint32_t end = nodes_[i].last_name;
+            if (names_[begin].size() == depth) {
+                // the name ending here sorts first and has no child
+                ++begin;
+            }
+
+            nodes_[i].first_child = static_cast<uint32_t>(nodes_.size());
+            while (begin < end) {
+                const char byte = names_[begin][depth];
+                uint32_t group_end = begin + 1;
+                while (group_end < end && names_[group_end][depth] == byte) {
+                    ++group_end;
+                }
+
+                Node child;
+                child.depth = CommonPrefixLength(names_[begin], names_[group_end - 1]);
+                child.first_name = begin;
+                child.last_name = group_end;
+                nodes_.push_back(child);
+                first_bytes_.push_back(byte);
+                begin = group_end;
+            }
+            nodes_[i].children_count = static_cast<uint32_t>(nodes_.size()) - nodes_[i].first_child;
+        }
+    }
+
+    vector<NameTrie::Match> NameTrie::Search(string_view query, size_t count, bool fuzzy) const {
+        vector<Match> matches;
+        if (names_.empty() || count == 0) {
+            return matches;
+        }
+
+        const auto [exact_begin, exact_end] = FindPrefixRange(query);
+        for (uint32_t id = exact_begin; id < exact_end && matches.size() < count; ++id) {
+            matches.push_back({names_[id], 0});
+        }
+        if (!fuzzy || matches.size() == count) {
+            return matches;
+        }
+
+        // the emitted runs come in name order and never overlap; skip the exact ones already taken
+        auto emit = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t id = begin; id < end && matches.size() < count; ++id) {
+                if (id < exact_begin || id >= exact_end) {
+                    matches.push_back({names_[id], 1});
+                }
+            }
+            return matches.size() < count;
+        };
+
+        const size_t width = query.size() + 1;
+        vector<int> rows((max_length_ + 1) * width);
+        for (size_t j = 0; j < width; ++j) {
+            rows[j] = static_cast<int>(j);
+        }
+        if (query.size() <= 1) {
+            // the empty prefix is already one edit away
+            emit(0, static_cast<uint32_t>(names_.size()));
+        } else {
+            VisitWithinOneEdit(0, 0, query, rows, emit);
+        }
+        return matches;
+    }
+
+    size_t NameTrie::GetSize() const {
+        return names_.size();
+    }
+
+    pair<uint32_t, uint32_t> NameTrie::FindPrefixRange(string_view query) const {
+        uint32_t node = 0;
+        uint32_t parent_depth = 0;
+        while (true) {
+            const string_view label = GetLabel(node, parent_depth);
+            const size_t compared = min<size_t>(label.size(), query.size() - parent_depth);
+            if (label.substr(0, compared) != query.substr(parent_depth, compared)) {
+                return {0, 0};
+            }
+            if (query.size() <= nodes_[node].depth) {
+                return {nodes_[node].first_name, nodes_[node].last_name};
+            }
+
+            parent_depth = nodes_[node].depth;
+            const auto children_begin = first_bytes_.begin() + nodes_[node].first_child;
+            const auto children_end = children_begin + nodes_[node].children_count;
+            // names sort by unsigned bytes, and so do the children
+            const auto child = lower_bound(children_begin, children_end, query[parent_depth], [](char lhs, char rhs) {
+                return static_cast<unsigned char>(lhs) < static_cast<unsigned char>(rhs);
+            });
+            if (child == children_end || *child != query[parent_depth]) {
+                return {0, 0};
+            }
+            node = static_cast<uint32_t>(child - first_bytes_.begin());
+        }
+    }
+
+    string_view NameTrie::GetLabel(uint32_t node, uint32_t parent_depth) const {
+        return names_[nodes_[node].first_name].substr(parent_depth, nodes_[node].depth - parent_depth);
+    }
+
+    template <typename Emit>
+    bool NameTrie::VisitWithinOneEdit(uint32_t node, uint32_t parent_depth, string_view query,
+                                      vector<int>& rows, Emit& emit) const {
+        const size_t width = query.size() + 1;
+        const string_view label = GetLabel(node, parent_depth);
+
+        for (size_t i = 0; i < label.size(); ++i) {
+            // row for the prefix of length depth from the row of depth - 1
+            const size_t depth = parent_depth + i + 1;
+            const int* previous = &rows[(depth - 1) * width];
+            int* current = &rows[depth * width];
+            current[0] = previous[0] + 1;
+            int row_min = current[0];
+            for (size_t j = 1; j < width; ++j) {
+                current[j] = min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + (query[j - 1] != label[i] ? 1 : 0)});
+                row_min = min(row_min, current[j]);
+            }
+
+            if (current[query.size()] <= 1) {
+                // this prefix is within one edit, so is every name below
+                return emit(nodes_[node].first_name, nodes_[node].last_name);
+            }
+            if (row_min > 1) {
+                return true;
+            }
+        }
+
+        const uint32_t first_child = nodes_[node].first_child;
+        for (uint32_t child = first_child; child < first_child + nodes_[node].children_count; ++child) {
+            if (!VisitWithinOneEdit(child, nodes_[node].depth, query, rows, emit)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
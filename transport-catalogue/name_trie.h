@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tc {
+
+    // Path-compressed trie over a frozen set of names, laid out breadth first:
+    // the children of a node are adjacent, and their first bytes sit in one small array.
+    // Names are kept sorted, so every node covers a contiguous run of them and
+    // the matches below a node come out in order without visiting the subtree.
+    class NameTrie {
+    public:
+        struct Match {
+            std::string_view name;
+            // 0 when the name starts with the query, 1 when it starts with a one-edit variant of it
+            int distance;
+        };
+
+        // duplicates are dropped; the viewed strings must outlive the trie
+        void Build(std::vector<std::string_view> names);
+        // up to count names starting with the query, then (if fuzzy) names starting with something
+        // one insertion, deletion or substitution away from it; each group in name order
+        std::vector<Match> Search(std::string_view query, size_t count, bool fuzzy) const;
+        size_t GetSize() const;
+
+    private:
+        struct Node {
+            uint32_t first_child = 0;
+            uint32_t children_count = 0;
+            // the node stands for the first `depth` bytes of each of its names
+            uint32_t depth = 0;
+            // its names are names_[first_name .. last_name)
+            uint32_t first_name = 0;
+            uint32_t last_name = 0;
+        };
+
+        std::pair<uint32_t, uint32_t> FindPrefixRange(std::string_view query) const;
+        std::string_view GetLabel(uint32_t node, uint32_t parent_depth) const;
+        // depth-first over the nodes, keeping one Levenshtein row per label byte in rows
+        template <typename Emit>
+        bool VisitWithinOneEdit(uint32_t node, uint32_t parent_depth, std::string_view query,
+                                std::vector<int>& rows, Emit& emit) const;
+
+        std::vector<std::string_view> names_;
+        std::vector<Node> nodes_;
+        // first byte of the label of each node (0 for the root)
+        std::vector<char> first_bytes_;
+        size_t max_length_ = 0;
+    };
+}
@@ -0,0 +1,144 @@
+#include "network_columns.h"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace std;
+
+namespace tc {
+
+    namespace {
+        // four running sums keep the additions independent, so the loop pipelines and vectorizes
+        double SumColumn(const vector<double>& column) {
+            double sums[4] = {0.0, 0.0, 0.0, 0.0};
+            size_t i = 0;
+            for (; i + 4 <= column.size(); i += 4) {
+                sums[0] += column[i];
+                sums[1] += column[i + 1];
+                sums[2] += column[i + 2];
+                sums[3] += column[i + 3];
+            }
+            for (; i < column.size(); ++i) {
+                sums[0] += column[i];
+            }
+            return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+    }
+
+    void NetworkColumns::Clear() {
+        *this = NetworkColumns();
+    }
+
+    void NetworkColumns::Reserve(size_t stops_count, size_t buses_count) {
+        stop_names_.reserve(stops_count);
+        stop_lat_.reserve(stops_count);
+        stop_lng_.reserve(stops_count);
+        stop_buses_count_.reserve(stops_count);
+
+        bus_names_.reserve(buses_count);
+        bus_is_roundtrip_.reserve(buses_count);
+        bus_stops_count_.reserve(buses_count);
+        bus_length_.reserve(buses_count);
+        bus_curvature_.reserve(buses_count);
+        bus_stop_offsets_.reserve(buses_count + 1);
+    }
+
+    void NetworkColumns::AddStop(const Stop& stop, uint32_t buses_count) {
+        stop_names_.push_back(stop.name);
+        stop_lat_.push_back(stop.position.lat);
+        stop_lng_.push_back(stop.position.lng);
+        stop_buses_count_.push_back(buses_count);
+    }
+
+    void NetworkColumns::AddBus(const Bus& bus, const BusStat& stat, const vector<uint32_t>& stop_ids) {
+        bus_names_.push_back(bus.name);
+        bus_is_roundtrip_.push_back(bus.is_roundtrip ? 1 : 0);
+        bus_stops_count_.push_back(static_cast<uint32_t>(stat.stops_count));
+        bus_length_.push_back(stat.length);
+        bus_curvature_.push_back(stat.curvature);
+        bus_stop_ids_.insert(bus_stop_ids_.end(), stop_ids.begin(), stop_ids.end());
+        bus_stop_offsets_.push_back(static_cast<uint32_t>(bus_stop_ids_.size()));
+    }
+
+    NetworkSummary NetworkColumns::GetSummary() const {
+        NetworkSummary summary;
+        summary.stops_count = static_cast<int>(stop_lat_.size());
+        summary.served_stops_count = static_cast<int>(count_if(stop_buses_count_.begin(), stop_buses_count_.end(), [](uint32_t count) {
+            return count > 0;
+        }));
+        if (!stop_lat_.empty()) {
+            const auto [min_lat, max_lat] = minmax_element(stop_lat_.begin(), stop_lat_.end());
+            const auto [min_lng, max_lng] = minmax_element(stop_lng_.begin(), stop_lng_.end());
+            summary.min = {*min_lat, *min_lng};
+            summary.max = {*max_lat, *max_lng};
+        }
+
+        summary.buses_count = static_cast<int>(bus_names_.size());
+        summary.roundtrip_buses_count = accumulate(bus_is_roundtrip_.begin(), bus_is_roundtrip_.end(), 0);
+        summary.route_stops_count = accumulate(bus_stops_count_.begin(), bus_stops_count_.end(), int64_t{0});
+        summary.total_length = SumColumn(bus_length_);
+
+        // buses without stops have zero length and curvature and stay out of the averages
+        const auto buses_with_stops = count_if(bus_stops_count_.begin(), bus_stops_count_.end(), [](uint32_t count) {
+            return count > 0;
+        });
+        if (buses_with_stops > 0) {
+            summary.average_length = summary.total_length / buses_with_stops;
+            summary.average_curvature = SumColumn(bus_curvature_) / buses_with_stops;
+        }
+        return summary;
+    }
+
+    vector<RouteLength> NetworkColumns::GetLongestRoutes(size_t count) const {
+        vector<uint32_t> ids;
+        ids.reserve(bus_names_.size());
+        for (uint32_t id = 0; id < bus_stops_count_.size(); ++id) {
+            if (bus_stops_count_[id] > 0) {
+                ids.push_back(id);
+            }
+        }
+
+        count = min(count, ids.size());
+        partial_sort(ids.begin(), ids.begin() + count, ids.end(), [this](uint32_t lhs, uint32_t rhs) {
+            if (bus_length_[lhs] != bus_length_[rhs]) {
+                return bus_length_[lhs] > bus_length_[rhs];
+            }
+            return bus_names_[lhs] < bus_names_[rhs];
+        });
+
+        vector<RouteLength> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            result.push_back({bus_names_[ids[i]], bus_length_[ids[i]]});
+        }
+        return result;
+    }
+
+    CurvatureDistribution NetworkColumns::GetCurvatureDistribution(size_t buckets_count) const {
+        CurvatureDistribution distribution;
+        distribution.counts.assign(buckets_count, 0);
+
+        bool any = false;
+        for (size_t id = 0; id < bus_curvature_.size(); ++id) {
+            if (bus_stops_count_[id] == 0) {
+                continue;
+            }
+            distribution.min = any ? min(distribution.min, bus_curvature_[id]) : bus_curvature_[id];
+            distribution.max = any ? max(distribution.max, bus_curvature_[id]) : bus_curvature_[id];
+            any = true;
+        }
+        if (!any || buckets_count == 0) {
+            return distribution;
+        }
+
+        const double width = (distribution.max - distribution.min) / buckets_count;
+        for (size_t id = 0; id < bus_curvature_.size(); ++id) {
+            if (bus_stops_count_[id] == 0) {
+                continue;
+            }
+            const size_t bucket = width > 0.0 ? static_cast<size_t>((bus_curvature_[id] - distribution.min) / width) : 0;
+            ++distribution.counts[min(bucket, buckets_count - 1)];
+        }
+        return distribution;
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace tc {
+
+    // Column-per-attribute copy of the frozen network for whole-catalogue scans.
+    // Stop i and bus i are the catalogue's stop and bus ids; names are views into the catalogue.
+    class NetworkColumns {
+    public:
+        void Clear();
+        void Reserve(size_t stops_count, size_t buses_count);
+        void AddStop(const Stop& stop, uint32_t buses_count);
+        // stop_ids as listed on the bus; stat.stops_count == 0 marks a bus without stops
+        void AddBus(const Bus& bus, const BusStat& stat, const std::vector<uint32_t>& stop_ids);
+
+        NetworkSummary GetSummary() const;
+        // up to count buses, longest road length first, ties by name
+        std::vector<RouteLength> GetLongestRoutes(size_t count) const;
+        // equal-width buckets between the smallest and the largest curvature of buses with stops
+        CurvatureDistribution GetCurvatureDistribution(size_t buckets_count) const;
+
+    private:
+        // stops
+        std::vector<std::string_view> stop_names_;
+        std::vector<double> stop_lat_;
+        std::vector<double> stop_lng_;
+        std::vector<uint32_t> stop_buses_count_;
+
+        // buses; stops of bus i are bus_stop_ids_[bus_stop_offsets_[i] .. bus_stop_offsets_[i + 1])
+        std::vector<std::string_view> bus_names_;
+        std::vector<uint8_t> bus_is_roundtrip_;
+        std::vector<uint32_t> bus_stops_count_;
+        std::vector<double> bus_length_;
+        std::vector<double> bus_curvature_;
+        std::vector<uint32_t> bus_stop_offsets_{0};
+        std::vector<uint32_t> bus_stop_ids_;
+    };
+}
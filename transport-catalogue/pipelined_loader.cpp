@@ -0,0 +1,160 @@
+#include "pipelined_loader.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <variant>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double SecondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Base requests passed from the parsing thread to the indexing one in batches,
+    // so that the two rarely meet on the mutex.
+    class BaseRequestsQueue final : public BaseRequestsSink {
+    public:
+        using Batch = std::vector<std::variant<Stop, Bus>>;
+
+        void AddStop(Stop&& stop) override {
+            Add(std::move(stop));
+        }
+
+        void AddBus(Bus&& bus) override {
+            Add(std::move(bus));
+        }
+
+        // called by the parsing thread once it is done or has failed: Pop hands out the rest, then returns false
+        void Close() {
+            {
+                std::lock_guard guard(mutex_);
+                if (!filling_.empty()) {
+                    ready_.push_back(std::move(filling_));
+                }
+                closed_ = true;
+            }
+            has_batches_.notify_one();
+        }
+
+        bool Pop(Batch& batch) {
+            std::unique_lock lock(mutex_);
+            has_batches_.wait(lock, [this] {
+                return closed_ || !ready_.empty();
+            });
+            if (ready_.empty()) {
+                return false;
+            }
+            batch = std::move(ready_.front());
+            ready_.pop_front();
+            return true;
+        }
+
+    private:
+        static constexpr size_t BATCH_SIZE = 1024;
+
+        template <typename Request>
+        void Add(Request&& request) {
+            filling_.emplace_back(std::move(request));
+            if (filling_.size() < BATCH_SIZE) {
+                return;
+            }
+            {
+                std::lock_guard guard(mutex_);
+                ready_.push_back(std::move(filling_));
+            }
+            has_batches_.notify_one();
+            filling_ = Batch();
+            filling_.reserve(BATCH_SIZE);
+        }
+
+        // only touched by the parsing thread
+        Batch filling_;
+        std::mutex mutex_;
+        std::condition_variable has_batches_;
+        std::deque<Batch> ready_;
+        bool closed_ = false;
+    };
+
+    template <typename Input>
+    PipelinedLoad Load(Input& input, ThreadPool* pool) {
+        const Clock::time_point start = Clock::now();
+        PipelinedLoad load;
+        BaseRequestsQueue queue;
+
+        std::future<double> parsed = std::async(std::launch::async, [&input, pool, &load, &queue, start] {
+            try {
+                if constexpr (std::is_same_v<Input, std::string_view>) {
+                    load.queries = pool != nullptr ? BindJson(input, load.cities, queue, *pool)
+                                                   : BindJson(input, load.cities, queue);
+                } else {
+                    load.queries = BindJson(input, load.cities, queue);
+                }
+            } catch (...) {
+                queue.Close();
+                throw;
+            }
+            queue.Close();
+            return SecondsSince(start);
+        });
+
+        tc::TransportCatalogue catalogue;
+        BaseRequestsQueue::Batch batch;
+        while (queue.Pop(batch)) {
+            for (std::variant<Stop, Bus>& request : batch) {
+                if (Stop* stop = std::get_if<Stop>(&request)) {
+                    catalogue.AddStop(std::move(*stop));
+                } else {
+                    catalogue.AddBus(std::get<Bus>(std::move(request)));
+                }
+            }
+        }
+        load.timings.index = SecondsSince(start);
+        load.timings.parse = parsed.get();
+        // the catalogue has interned its own copies
+        load.queries.names = StringArena();
+
+        Clock::time_point stage = Clock::now();
+        for (const Stop& stop : catalogue.GetStops()) {
+            catalogue.SetDistance(stop);
+        }
+        load.timings.distances = SecondsSince(stage);
+
+        if (!load.cities) {
+            stage = Clock::now();
+            catalogue.SetDistanceFormula(load.queries.routing_settings.distance_formula);
+            catalogue.Freeze();
+            load.timings.freeze = SecondsSince(stage);
+
+            stage = Clock::now();
+            load.snapshot = std::make_unique<CatalogueSnapshot>(std::move(catalogue), load.queries.render_settings,
+                                                                load.queries.routing_settings);
+            load.timings.graph = SecondsSince(stage);
+        }
+
+        load.timings.total = SecondsSince(start);
+        return load;
+    }
+}
+
+std::ostream& operator<<(std::ostream& output, const LoadTimings& timings) {
+    return output << "parse " << timings.parse << " s, index " << timings.index << " s, distances " << timings.distances
+                  << " s, freeze " << timings.freeze << " s, graph " << timings.graph << " s, total " << timings.total << " s";
+}
+
+PipelinedLoad LoadPipelined(std::string_view text) {
+    return Load(text, nullptr);
+}
+
+PipelinedLoad LoadPipelined(std::string_view text, ThreadPool& pool) {
+    return Load(text, &pool);
+}
+
+PipelinedLoad LoadPipelined(std::istream& input) {
+    return Load(input, nullptr);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "json_reader.h"
+#include "versioned_catalogue.h"
+
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// Wall time of the stages of LoadPipelined, in seconds.
+// Parsing and indexing run at the same time, so both are counted from the start.
+struct LoadTimings {
+    // the whole input, stat requests and settings included
+    double parse = 0.0;
+    // until the last stop and bus parsed is in the catalogue
+    double index = 0.0;
+    // road distances, deferred until every stop is known
+    double distances = 0.0;
+    double freeze = 0.0;
+    // routes graph, router and renderer
+    double graph = 0.0;
+    double total = 0.0;
+};
+
+std::ostream& operator<<(std::ostream& output, const LoadTimings& timings);
+
+struct PipelinedLoad {
+    // stat requests and settings; the stops and buses are in snapshot
+    DBQueries queries;
+    std::optional<std::vector<CityQueries>> cities;
+    // left empty for a multi-city input, whose cities are loaded on their own
+    std::unique_ptr<CatalogueSnapshot> snapshot;
+    LoadTimings timings;
+};
+
+// The input is read on another thread while the stops and buses already read are added to the catalogue.
+// Road distances wait until every stop is in, then the catalogue is frozen and the graph built.
+// Gives the same snapshot as BindJson followed by CatalogueSnapshot.
+PipelinedLoad LoadPipelined(std::string_view text);
+// base_requests are read in parts on the pool's threads, each indexed in order as soon as it is read
+PipelinedLoad LoadPipelined(std::string_view text, ThreadPool& pool);
+PipelinedLoad LoadPipelined(std::istream& input);
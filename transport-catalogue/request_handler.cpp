@@ -20,21 +20,22 @@ RequestHandler::RequestHandler(const tc::TransportCatalogue& transport_catalogue
 }
 
 const BusStat RequestHandler::GetBusStat(const std::string_view bus_name) const {
+    if (auto bus_stat = transport_catalogue_.GetBusStat(bus_name)) {
+        return *bus_stat;
+    }
+
     BusStat bus_route;
     bus_route.bus_name = bus_name;
+    return bus_route;
+}
 
+const std::optional<SegmentStat> RequestHandler::GetSegment(const std::string_view bus_name, size_t from_position, size_t to_position) const {
     const Bus* bus = transport_catalogue_.GetRouteByBusName(bus_name);
     if (bus == nullptr) {
-        return bus_route;
+        return std::nullopt;
     }
-    
-    bus_route.stops_count = CalculateStopCount(bus);
-    bus_route.unique_stops = GetUniqueStops(bus);
-    bus_route.length = CalculateRealLength(bus);
-    double gps_length = CalculateGPSLength(bus);
-    bus_route.curvature = CalculateCurvature(bus_route.length, gps_length);
-    
-    return bus_route;
+
+    return transport_catalogue_.GetSegmentStat(bus, from_position, to_position);
 }
 
 const BusesToStop RequestHandler::GetBusesByStop(const std::string_view stop_name) const {
@@ -53,6 +54,37 @@ const BusesToStop RequestHandler::GetBusesByStop(const std::string_view stop_nam
     return bus;
 }
 
+const std::vector<StopDistance> RequestHandler::GetNearestStops(geo::Coordinates point, size_t count) const {
+    return transport_catalogue_.GetNearestStops(point, count);
+}
+
+const std::vector<const Stop*> RequestHandler::GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+    return transport_catalogue_.GetStopsInBox(min, max);
+}
+
+const NetworkSummary RequestHandler::GetNetworkSummary() const {
+    return transport_catalogue_.GetColumns().GetSummary();
+}
+
+const std::vector<RouteLength> RequestHandler::GetLongestRoutes(size_t count) const {
+    return transport_catalogue_.GetColumns().GetLongestRoutes(count);
+}
+
+const CurvatureDistribution RequestHandler::GetCurvatureDistribution(size_t buckets_count) const {
+    return transport_catalogue_.GetColumns().GetCurvatureDistribution(buckets_count);
+}
+
+const std::optional<std::vector<tc::NameTrie::Match>> RequestHandler::SearchNames(const std::string_view kind, const std::string_view query,
+                                                                                  size_t count, bool fuzzy) const {
+    if (kind == "Stop") {
+        return transport_catalogue_.SearchStopNames(query, count, fuzzy);
+    }
+    if (kind == "Bus") {
+        return transport_catalogue_.SearchBusNames(query, count, fuzzy);
+    }
+    return std::nullopt;
+}
+
 geo::Coordinates RequestHandler::GetLatAndLng(std::string_view stop) const{
     double lat = transport_catalogue_.GetStopByName(stop)->position.lat;
     double lng = transport_catalogue_.GetStopByName(stop)->position.lng;
@@ -141,65 +173,15 @@ svg::Document RequestHandler::RenderMap() const {
 }
 
 
-double RequestHandler::CalculateCurvature(double bus_route_length, double gps_length) const {
-    constexpr double EPSILON = 1e-6;
-    
-    if (std::abs(gps_length) < EPSILON) {
-        return 0.0;
-    } else {
-        return bus_route_length / gps_length;
-    }
-
-}
-
-double RequestHandler::CalculateGPSLength(const Bus* bus) const {
-    const auto& stops = bus->stops;
-    double direct_length = 0.0;
-    for (auto it = stops.begin(); it + 1 != stops.end(); ++it) {
-        auto* stop_prev = transport_catalogue_.GetStopByName(*it);
-        auto* stop_next = transport_catalogue_.GetStopByName(*(std::next(it)));
-        direct_length += geo::ComputeDistance({ stop_prev->position.lat, stop_prev->position.lng }, { stop_next->position.lat, stop_next->position.lng });
-    }
-
-    if (!bus->is_roundtrip) {
-        return 2 * direct_length;
-    }
-
-    return direct_length;
-}
-
-int RequestHandler::CalculateRealLength(const Bus* bus) const {
-    const auto& stops = bus->stops;
-    int length = 0.0;
-    for (auto it = stops.begin(); it + 1 != stops.end(); ++it) {
-        auto* stop_prev = transport_catalogue_.GetStopByName(*it);
-        auto* stop_next = transport_catalogue_.GetStopByName(*(std::next(it)));
-        auto distance_prev_next = transport_catalogue_.GetDistanceBetweenStops(stop_prev, stop_next);
-        auto distance_next_prev = transport_catalogue_.GetDistanceBetweenStops(stop_next, stop_prev);
-
-        if (bus->is_roundtrip) {
-            length += distance_prev_next.value();
-        } else {
-            length += distance_prev_next.value() + distance_next_prev.value();
-        }
-    }
-    return length;
-}
-
-int RequestHandler::GetUniqueStops(const Bus* bus) const {
-    std::unordered_set<std::string_view> unique_stops(bus->stops.begin(), bus->stops.end());
-
-    return static_cast<int>(unique_stops.size());
-}
-
-int RequestHandler::CalculateStopCount(const Bus* bus) const {
-    int stops_count = static_cast<int>(bus->stops.size());
-    
-    if (!bus->is_roundtrip) {
-        stops_count = 2 * stops_count - 1;
-    }
-    
-    return stops_count;
+const ComponentStat RequestHandler::GetComponentStat() const {
+    const graph::Components& components = transport_router_.GetComponents();
+    ComponentStat stat;
+    stat.strong_count = static_cast<int>(components.GetStrongCount());
+    stat.largest_strong_size = static_cast<int>(components.GetLargestStrongSize());
+    stat.weak_count = static_cast<int>(components.GetWeakCount());
+    stat.largest_weak_size = static_cast<int>(components.GetLargestWeakSize());
+    stat.isolated_count = static_cast<int>(components.GetIsolatedCount());
+    return stat;
 }
 
 const std::optional<RouteStat> RequestHandler::GetRoute(std::string_view from, std::string_view to) const {
@@ -208,6 +190,9 @@ const std::optional<RouteStat> RequestHandler::GetRoute(std::string_view from, s
     const Stop* stop_to = transport_catalogue_.GetStopByName(to);
     graph::VertexId idx_stop_from = transport_catalogue_.GetStopIndex(stop_from);
     graph::VertexId idx_stop_to = transport_catalogue_.GetStopIndex(stop_to);
+    if (!transport_router_.GetComponents().MayReach(idx_stop_from, idx_stop_to)) {
+        return std::nullopt;
+    }
     std::optional<graph::Router<double>::RouteInfo> route_info = router_.BuildRoute(idx_stop_from, idx_stop_to);
 
     if (route_info == std::nullopt) {
@@ -216,3 +201,59 @@ const std::optional<RouteStat> RequestHandler::GetRoute(std::string_view from, s
     
     return transport_router_.GetRoute(routing_settings, route_info, transport_router_);
 }
+
+namespace {
+    RouteElement MakeWalk(std::string_view stop_from, std::string_view stop_to, double distance, double velocity) {
+        RouteElement walk;
+        walk.type = "Walk";
+        walk.stop_name = std::string(stop_from);
+        walk.stop_to = std::string(stop_to);
+        walk.distance = static_cast<int>(std::lround(distance));
+        walk.time = distance / velocity;
+        walk.span_count = 0;
+        return walk;
+    }
+}
+
+const std::optional<RouteStat> RequestHandler::GetRoute(geo::Coordinates from, geo::Coordinates to) const {
+    const RoutingSettings& routing_settings = transport_router_.GetRouterSettings();
+    const size_t candidates = static_cast<size_t>(std::max(routing_settings.walk_stop_candidates, 0));
+    const std::vector<StopDistance> stops_from = transport_catalogue_.GetNearestStops(from, candidates);
+    const std::vector<StopDistance> stops_to = transport_catalogue_.GetNearestStops(to, candidates);
+
+    using Endpoint = graph::Router<double>::Endpoint;
+    std::vector<Endpoint> sources;
+    sources.reserve(stops_from.size());
+    for (const auto& [stop, distance] : stops_from) {
+        sources.push_back({transport_catalogue_.GetStopIndex(stop), distance / routing_settings.walk_velocity});
+    }
+    std::vector<Endpoint> targets;
+    targets.reserve(stops_to.size());
+    for (const auto& [stop, distance] : stops_to) {
+        targets.push_back({transport_catalogue_.GetStopIndex(stop), distance / routing_settings.walk_velocity});
+    }
+
+    RouteStat walk_only;
+    const double door_to_door = geo::ComputeDistance(from, to);
+    walk_only.items.push_back(MakeWalk({}, {}, door_to_door, routing_settings.walk_velocity));
+    walk_only.total_time = walk_only.items.back().time;
+    walk_only.bus_wait_time = routing_settings.bus_wait_time;
+
+    const auto best = router_.BuildRoute(sources, targets);
+    if (!best || best->weight >= walk_only.total_time) {
+        return walk_only;
+    }
+
+    RouteStat route_stat = transport_router_.GetRoute(routing_settings, best->route, transport_router_);
+    const StopDistance& first = stops_from[best->source];
+    const StopDistance& last = stops_to[best->target];
+    if (first.distance > 0.0) {
+        route_stat.items.push_front(MakeWalk({}, first.stop->name, first.distance, routing_settings.walk_velocity));
+    }
+    if (last.distance > 0.0) {
+        route_stat.items.push_back(MakeWalk(last.stop->name, {}, last.distance, routing_settings.walk_velocity));
+    }
+    route_stat.total_time = best->weight;
+    route_stat.bus_wait_time = routing_settings.bus_wait_time;
+    return route_stat;
+}
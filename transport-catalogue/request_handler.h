@@ -8,6 +8,7 @@
 #include <optional>
 #include <set>
 #include <string_view>
+#include <vector>
 
 using Container_stops_points = std::deque<std::pair<svg::Point, std::string_view>>;
 
@@ -18,21 +19,27 @@ public:
                    const TransportRouter& transport_router);
 
     const BusStat GetBusStat(const std::string_view bus_name) const;
+    const std::optional<SegmentStat> GetSegment(const std::string_view bus_name, size_t from_position, size_t to_position) const;
     const BusesToStop GetBusesByStop(const std::string_view stop_name) const;
+    const std::vector<StopDistance> GetNearestStops(geo::Coordinates point, size_t count) const;
+    const std::vector<const Stop*> GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+    const NetworkSummary GetNetworkSummary() const;
+    const std::vector<RouteLength> GetLongestRoutes(size_t count) const;
+    const CurvatureDistribution GetCurvatureDistribution(size_t buckets_count) const;
+    // kind is "Stop" or "Bus"
+    const std::optional<std::vector<tc::NameTrie::Match>> SearchNames(const std::string_view kind, const std::string_view query,
+                                                                      size_t count, bool fuzzy) const;
+    const ComponentStat GetComponentStat() const;
     svg::Document RenderMap() const;
     const std::optional<RouteStat> GetRoute(const std::string_view from, const std::string_view to) const;
+    // door to door: walk to one of the stops nearest to `from`, ride, walk from a stop nearest to `to`
+    const std::optional<RouteStat> GetRoute(geo::Coordinates from, geo::Coordinates to) const;
     
     svg::Document DrawPolyline(svg::Document doc, SphereProjector sp, size_t colors_in_palete) const;
     svg::Document DrawBusName(svg::Document doc, SphereProjector sp, size_t colors_in_palete) const;
     geo::Coordinates GetLatAndLng(std::string_view stop) const;
 
 private:
-    int GetUniqueStops(const Bus* bus) const;
-    double CalculateGPSLength(const Bus* bus) const;
-    int CalculateRealLength(const Bus* bus) const;
-    double CalculateCurvature(double bus_route_length, double gps_length) const;
-    int CalculateStopCount(const Bus* bus) const;
-
     const tc::TransportCatalogue& transport_catalogue_;
     const MapRenderer& renderer_;
     const graph::Router<double>& router_;
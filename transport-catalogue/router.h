@@ -29,6 +29,24 @@ public:
 
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
 
+    // a vertex together with the cost of getting to (or away from) it
+    struct Endpoint {
+        VertexId vertex;
+        Weight weight;
+    };
+
+    struct MultiRouteInfo {
+        size_t source;
+        size_t target;
+        Weight weight;
+        RouteInfo route;
+    };
+
+    // cheapest route from any source to any target, endpoint weights included;
+    // scans the precomputed weights and rebuilds the path of the winner only
+    std::optional<MultiRouteInfo> BuildRoute(const std::vector<Endpoint>& sources,
+                                             const std::vector<Endpoint>& targets) const;
+
 private:
     struct RouteInternalData {
         Weight weight;
@@ -114,4 +132,31 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight>
+std::optional<typename Router<Weight>::MultiRouteInfo> Router<Weight>::BuildRoute(
+    const std::vector<Endpoint>& sources, const std::vector<Endpoint>& targets) const {
+    std::optional<std::pair<size_t, size_t>> best;
+    Weight best_weight{};
+    for (size_t source = 0; source < sources.size(); ++source) {
+        const auto& row = routes_internal_data_.at(sources[source].vertex);
+        for (size_t target = 0; target < targets.size(); ++target) {
+            const auto& route_internal_data = row.at(targets[target].vertex);
+            if (!route_internal_data) {
+                continue;
+            }
+            const Weight weight = sources[source].weight + route_internal_data->weight + targets[target].weight;
+            if (!best || weight < best_weight) {
+                best = {source, target};
+                best_weight = weight;
+            }
+        }
+    }
+    if (!best) {
+        return std::nullopt;
+    }
+
+    return MultiRouteInfo{best->first, best->second, best_weight,
+                          *BuildRoute(sources[best->first].vertex, targets[best->second].vertex)};
+}
+
 }  // namespace graph
\ No newline at end of file
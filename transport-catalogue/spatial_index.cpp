@@ -0,0 +1,195 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+namespace geo {
+
+namespace {
+
+const double METRES_PER_DEGREE = 6371000 * M_PI / 180.0;
+const size_t POINTS_PER_CELL = 2;
+
+bool IsCloser(const PointGrid::Neighbour& lhs, const PointGrid::Neighbour& rhs) {
+    return std::tie(lhs.distance, lhs.id) < std::tie(rhs.distance, rhs.id);
+}
+
+}  // namespace
+
+void PointGrid::Build(const std::vector<Coordinates>& points) {
+    cell_offsets_.clear();
+    cell_ids_.clear();
+    cell_points_.clear();
+    columns_ = rows_ = 0;
+    if (points.empty()) {
+        return;
+    }
+
+    Coordinates max = points.front();
+    min_ = points.front();
+    for (const Coordinates& point : points) {
+        min_.lat = std::min(min_.lat, point.lat);
+        min_.lng = std::min(min_.lng, point.lng);
+        max.lat = std::max(max.lat, point.lat);
+        max.lng = std::max(max.lng, point.lng);
+    }
+
+    const double dr = M_PI / 180.0;
+    const double mid_cos = std::cos((min_.lat + max.lat) / 2 * dr);
+    const double min_cos = std::cos(std::max(std::abs(min_.lat), std::abs(max.lat)) * dr);
+    const double height = (max.lat - min_.lat) * METRES_PER_DEGREE;
+    const double width = (max.lng - min_.lng) * METRES_PER_DEGREE * mid_cos;
+
+    // square cells (in metres) holding about POINTS_PER_CELL points on average
+    const double cells = std::max<double>(1.0, static_cast<double>(points.size() / POINTS_PER_CELL));
+    double side = std::sqrt(height * width / cells);
+    if (side <= 0.0) {
+        // all points on one line or in one place
+        side = std::max(height, width) / cells;
+    }
+    columns_ = side > 0.0 ? std::clamp(static_cast<int>(std::ceil(width / side)), 1, 1 << 15) : 1;
+    rows_ = side > 0.0 ? std::clamp(static_cast<int>(std::ceil(height / side)), 1, 1 << 15) : 1;
+
+    cell_lat_ = max.lat > min_.lat ? (max.lat - min_.lat) / rows_ : 1.0;
+    cell_lng_ = max.lng > min_.lng ? (max.lng - min_.lng) / columns_ : 1.0;
+    cell_height_ = cell_lat_ * METRES_PER_DEGREE;
+    cell_min_width_ = cell_lng_ * METRES_PER_DEGREE * std::max(min_cos, 0.0);
+
+    // counting sort of the points by cell
+    std::vector<uint32_t> point_cells(points.size());
+    cell_offsets_.assign(static_cast<size_t>(columns_) * rows_ + 1, 0);
+    for (size_t id = 0; id < points.size(); ++id) {
+        const auto [column, row] = GetCell(points[id]);
+        point_cells[id] = static_cast<uint32_t>(GetCellIndex(column, row));
+        ++cell_offsets_[point_cells[id] + 1];
+    }
+    for (size_t cell = 1; cell < cell_offsets_.size(); ++cell) {
+        cell_offsets_[cell] += cell_offsets_[cell - 1];
+    }
+
+    std::vector<uint32_t> fill(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    cell_ids_.resize(points.size());
+    cell_points_.resize(points.size());
+    for (size_t id = 0; id < points.size(); ++id) {
+        const uint32_t position = fill[point_cells[id]]++;
+        cell_ids_[position] = static_cast<uint32_t>(id);
+        cell_points_[position] = points[id];
+    }
+}
+
+std::vector<PointGrid::Neighbour> PointGrid::FindNearest(Coordinates center, size_t count) const {
+    std::vector<Neighbour> nearest;
+    count = std::min(count, cell_ids_.size());
+    if (count == 0) {
+        return nearest;
+    }
+    nearest.reserve(count);
+
+    const Position position = GetPosition(center);
+    const auto [column, row] = GetCell(center);
+
+    // nearest is a max-heap on distance while it is being filled
+    auto visit_cell = [&](int x, int y) {
+        if (nearest.size() == count && GetCellDistance(position, x, y) > nearest.front().distance) {
+            return;
+        }
+        const size_t cell = GetCellIndex(x, y);
+        for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+            Neighbour candidate{cell_ids_[i], ComputeDistance(center, cell_points_[i])};
+            if (nearest.size() < count) {
+                nearest.push_back(candidate);
+                std::push_heap(nearest.begin(), nearest.end(), IsCloser);
+            } else if (IsCloser(candidate, nearest.front())) {
+                std::pop_heap(nearest.begin(), nearest.end(), IsCloser);
+                nearest.back() = candidate;
+                std::push_heap(nearest.begin(), nearest.end(), IsCloser);
+            }
+        }
+    };
+
+    for (int ring = 0; ; ++ring) {
+        const double ring_distance = GetRingDistance(position, column, row, ring);
+        if (ring_distance == std::numeric_limits<double>::infinity()
+            || (nearest.size() == count && ring_distance > nearest.front().distance)) {
+            break;
+        }
+        ForEachCellInRing(column, row, ring, visit_cell);
+    }
+
+    std::sort_heap(nearest.begin(), nearest.end(), IsCloser);
+    return nearest;
+}
+
+std::vector<size_t> PointGrid::FindInBox(Coordinates min, Coordinates max) const {
+    std::vector<size_t> result;
+    if (cell_ids_.empty() || min.lat > max.lat || min.lng > max.lng) {
+        return result;
+    }
+
+    const auto [first_column, first_row] = GetCell(min);
+    const auto [last_column, last_row] = GetCell(max);
+    for (int y = first_row; y <= last_row; ++y) {
+        for (int x = first_column; x <= last_column; ++x) {
+            const size_t cell = GetCellIndex(x, y);
+            for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+                const Coordinates& point = cell_points_[i];
+                if (point.lat >= min.lat && point.lat <= max.lat && point.lng >= min.lng && point.lng <= max.lng) {
+                    result.push_back(cell_ids_[i]);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t PointGrid::GetSize() const {
+    return cell_ids_.size();
+}
+
+PointGrid::Position PointGrid::GetPosition(Coordinates point) const {
+    const double cos_lat = std::max(std::cos(point.lat * M_PI / 180.0), 0.0);
+    return {(point.lng - min_.lng) / cell_lng_, (point.lat - min_.lat) / cell_lat_,
+            std::min(cell_min_width_, cell_lng_ * METRES_PER_DEGREE * cos_lat)};
+}
+
+std::pair<int, int> PointGrid::GetCell(Coordinates point) const {
+    const int column = static_cast<int>(std::floor((point.lng - min_.lng) / cell_lng_));
+    const int row = static_cast<int>(std::floor((point.lat - min_.lat) / cell_lat_));
+    return {std::clamp(column, 0, columns_ - 1), std::clamp(row, 0, rows_ - 1)};
+}
+
+size_t PointGrid::GetCellIndex(int column, int row) const {
+    return static_cast<size_t>(row) * columns_ + column;
+}
+
+double PointGrid::GetCellDistance(const Position& position, int column, int row) const {
+    const double columns_between = std::max({0.0, column - position.column, position.column - (column + 1)});
+    const double rows_between = std::max({0.0, row - position.row, position.row - (row + 1)});
+    return std::hypot(columns_between * position.cell_width, rows_between * cell_height_) * RING_BOUND_SLACK;
+}
+
+double PointGrid::GetRingDistance(const Position& position, int column, int row, int ring) const {
+    // the ring cell closest to the query on each side lies in the query's own row or column
+    if (ring == 0) {
+        return GetCellDistance(position, column, row);
+    }
+    double distance = std::numeric_limits<double>::infinity();
+    if (column - ring >= 0) {
+        distance = std::min(distance, GetCellDistance(position, column - ring, row));
+    }
+    if (column + ring < columns_) {
+        distance = std::min(distance, GetCellDistance(position, column + ring, row));
+    }
+    if (row - ring >= 0) {
+        distance = std::min(distance, GetCellDistance(position, column, row - ring));
+    }
+    if (row + ring < rows_) {
+        distance = std::min(distance, GetCellDistance(position, column, row + ring));
+    }
+    return distance;
+}
+
+}  // namespace geo
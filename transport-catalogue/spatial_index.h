@@ -0,0 +1,143 @@
+#pragma once
+
+#include "geo.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace geo {
+
+// Uniform grid over a fixed set of points, about two points per cell.
+// Points are stored cell by cell, so a query only touches the cells it needs.
+class PointGrid {
+public:
+    struct Neighbour {
+        size_t id;
+        double distance;
+    };
+
+    // points[i] gets id i
+    void Build(const std::vector<Coordinates>& points);
+
+    // up to count nearest points, closest first
+    std::vector<Neighbour> FindNearest(Coordinates center, size_t count) const;
+    // points with min.lat <= lat <= max.lat and min.lng <= lng <= max.lng, in id order
+    std::vector<size_t> FindInBox(Coordinates min, Coordinates max) const;
+    // calls action(id, distance) for every point within radius metres of center
+    template <typename Action>
+    void ForEachWithin(Coordinates center, double radius, Action action) const;
+    // calls action(id, other_id, distance) once for every pair of distinct points within radius metres
+    template <typename Action>
+    void ForEachPairWithin(double radius, Action action) const;
+
+    size_t GetSize() const;
+
+private:
+    // the query point in fractional cell coordinates, not clamped to the grid
+    struct Position {
+        double column;
+        double row;
+        // metres per cell along a parallel, the smallest over the grid and the query latitude
+        double cell_width;
+    };
+
+    Position GetPosition(Coordinates point) const;
+    std::pair<int, int> GetCell(Coordinates point) const;
+    size_t GetCellIndex(int column, int row) const;
+    // lower bound in metres for points of the cell
+    double GetCellDistance(const Position& position, int column, int row) const;
+    // lower bound in metres for points of the cells `ring` steps away from (column, row); infinity past the grid
+    double GetRingDistance(const Position& position, int column, int row, int ring) const;
+    template <typename Visit>
+    void ForEachCellInRing(int column, int row, int ring, Visit visit) const;
+
+    // cell sizes are measured on a flat approximation; bounds built from them are kept a little short
+    static constexpr double RING_BOUND_SLACK = 0.99;
+
+    Coordinates min_{0.0, 0.0};
+    double cell_lat_ = 1.0;
+    double cell_lng_ = 1.0;
+    double cell_height_ = 0.0;
+    double cell_min_width_ = 0.0;
+    int columns_ = 0;
+    int rows_ = 0;
+
+    // points of cell c are cell_ids_/cell_points_[cell_offsets_[c] .. cell_offsets_[c + 1])
+    std::vector<uint32_t> cell_offsets_;
+    std::vector<uint32_t> cell_ids_;
+    std::vector<Coordinates> cell_points_;
+};
+
+template <typename Action>
+void PointGrid::ForEachWithin(Coordinates center, double radius, Action action) const {
+    if (cell_ids_.empty()) {
+        return;
+    }
+
+    const Position position = GetPosition(center);
+    const auto [column, row] = GetCell(center);
+    for (int ring = 0; GetRingDistance(position, column, row, ring) <= radius; ++ring) {
+        ForEachCellInRing(column, row, ring, [&](int x, int y) {
+            if (GetCellDistance(position, x, y) > radius) {
+                return;
+            }
+            const size_t cell = GetCellIndex(x, y);
+            for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+                if (const double distance = ComputeDistance(center, cell_points_[i]); distance <= radius) {
+                    action(static_cast<size_t>(cell_ids_[i]), distance);
+                }
+            }
+        });
+    }
+}
+
+template <typename Action>
+void PointGrid::ForEachPairWithin(double radius, Action action) const {
+    // cells `rings` + 1 steps apart have at least `rings` whole cells between them
+    const double cell_size = std::min(cell_height_, cell_min_width_) * RING_BOUND_SLACK;
+    int rings = 1;
+    while (rings < std::max(columns_, rows_) && rings * cell_size <= radius) {
+        ++rings;
+    }
+
+    // each pair is seen from the point that comes first in cell order
+    for (int row = 0; row < rows_; ++row) {
+        for (int column = 0; column < columns_; ++column) {
+            const size_t cell = GetCellIndex(column, row);
+            for (uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i) {
+                for (int y = row; y <= std::min(rows_ - 1, row + rings); ++y) {
+                    const int first_column = y == row ? column : std::max(0, column - rings);
+                    const size_t first = y == row ? i + 1 : cell_offsets_[GetCellIndex(first_column, y)];
+                    const size_t last = cell_offsets_[GetCellIndex(std::min(columns_ - 1, column + rings), y) + 1];
+                    for (size_t j = first; j < last; ++j) {
+                        if (const double distance = ComputeDistance(cell_points_[i], cell_points_[j]); distance <= radius) {
+                            action(static_cast<size_t>(cell_ids_[i]), static_cast<size_t>(cell_ids_[j]), distance);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <typename Visit>
+void PointGrid::ForEachCellInRing(int column, int row, int ring, Visit visit) const {
+    for (int y = std::max(0, row - ring); y <= std::min(rows_ - 1, row + ring); ++y) {
+        if (y == row - ring || y == row + ring) {
+            for (int x = std::max(0, column - ring); x <= std::min(columns_ - 1, column + ring); ++x) {
+                visit(x, y);
+            }
+        } else {
+            if (column - ring >= 0) {
+                visit(column - ring, y);
+            }
+            if (column + ring < columns_) {
+                visit(column + ring, y);
+            }
+        }
+    }
+}
+
+}  // namespace geo
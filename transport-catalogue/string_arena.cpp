@@ -0,0 +1,218 @@
+#include "string_arena.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+    constexpr size_t BLOCK_SIZE = 64 * 1024;
+}
+
+StringArena::StringArena(std::shared_ptr<SharedStringArena> shared)
+    : shared_(std::move(shared)) {
+}
+
+StringArena::StringArena(StringArena&& other) noexcept
+    : blocks_(std::move(other.blocks_))
+    , block_used_(std::exchange(other.block_used_, 0))
+    , block_capacity_(std::exchange(other.block_capacity_, 0))
+    , bytes_used_(std::exchange(other.bytes_used_, 0))
+    , interned_(std::move(other.interned_))
+    , shared_(std::move(other.shared_))
+    , shared_chunks_(std::move(other.shared_chunks_)) {
+    other.interned_.clear();
+    other.shared_chunks_.clear();
+}
+
+StringArena& StringArena::operator=(StringArena&& other) noexcept {
+    if (this != &other) {
+        ReleaseShared();
+        blocks_ = std::move(other.blocks_);
+        block_used_ = std::exchange(other.block_used_, 0);
+        block_capacity_ = std::exchange(other.block_capacity_, 0);
+        bytes_used_ = std::exchange(other.bytes_used_, 0);
+        interned_ = std::move(other.interned_);
+        other.interned_.clear();
+        shared_ = std::move(other.shared_);
+        shared_chunks_ = std::move(other.shared_chunks_);
+        other.shared_chunks_.clear();
+    }
+    return *this;
+}
+
+StringArena::~StringArena() {
+    ReleaseShared();
+}
+
+std::string_view StringArena::Intern(std::string_view str) {
+    if (auto it = interned_.find(str); it != interned_.end()) {
+        return *it;
+    }
+
+    std::string_view stored;
+    if (shared_) {
+        stored = shared_->Acquire({str}, shared_chunks_).front();
+        bytes_used_ += str.size();
+    } else {
+        stored = Store(str);
+    }
+    interned_.insert(stored);
+    return stored;
+}
+
+void StringArena::InternAll(const std::vector<std::string_view>& strs) {
+    if (!shared_) {
+        for (std::string_view str : strs) {
+            Intern(str);
+        }
+        return;
+    }
+
+    std::vector<std::string_view> missing;
+    for (std::string_view str : strs) {
+        if (interned_.count(str) == 0) {
+            missing.push_back(str);
+        }
+    }
+    std::sort(missing.begin(), missing.end());
+    missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+    for (std::string_view stored : shared_->Acquire(missing, shared_chunks_)) {
+        bytes_used_ += stored.size();
+        interned_.insert(stored);
+    }
+}
+
+bool StringArena::Contains(std::string_view str) const {
+    return interned_.count(str) > 0;
+}
+
+void StringArena::Reserve(size_t strings_count) {
+    interned_.reserve(strings_count);
+}
+
+size_t StringArena::GetStringsCount() const {
+    return interned_.size();
+}
+
+size_t StringArena::GetBytesUsed() const {
+    return bytes_used_;
+}
+
+void StringArena::ReleaseShared() {
+    if (shared_ && !shared_chunks_.empty()) {
+        shared_->Release(shared_chunks_);
+        shared_chunks_.clear();
+    }
+}
+
+std::string_view StringArena::Store(std::string_view str) {
+    if (str.empty()) {
+        return {};
+    }
+
+    if (str.size() > BLOCK_SIZE / 4) {
+        // long strings get a block of their own, kept in front of the partially filled one
+        auto block = std::make_unique<char[]>(str.size());
+        char* dest = block.get();
+        std::memcpy(dest, str.data(), str.size());
+        blocks_.insert(block_capacity_ > 0 ? blocks_.end() - 1 : blocks_.end(), std::move(block));
+        bytes_used_ += str.size();
+        return {dest, str.size()};
+    }
+
+    if (block_used_ + str.size() > block_capacity_) {
+        blocks_.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+        block_used_ = 0;
+        block_capacity_ = BLOCK_SIZE;
+    }
+
+    char* dest = blocks_.back().get() + block_used_;
+    std::memcpy(dest, str.data(), str.size());
+    block_used_ += str.size();
+    bytes_used_ += str.size();
+    return {dest, str.size()};
+}
+
+struct SharedStringArena::Chunk {
+    std::unique_ptr<char[]> data;
+    size_t size = 0;
+    std::vector<std::string_view> strings;
+    size_t holders = 0;
+};
+
+SharedStringArena::SharedStringArena() = default;
+SharedStringArena::~SharedStringArena() = default;
+
+std::vector<std::string_view> SharedStringArena::Acquire(const std::vector<std::string_view>& strs, std::vector<Chunk*>& held) {
+    const auto hold = [&held](Chunk* chunk) {
+        if (std::find(held.begin(), held.end(), chunk) == held.end()) {
+            ++chunk->holders;
+            held.push_back(chunk);
+        }
+    };
+
+    std::vector<std::string_view> result(strs.size());
+    std::vector<size_t> missing;
+    size_t missing_size = 0;
+
+    std::lock_guard guard(mutex_);
+    for (size_t i = 0; i < strs.size(); ++i) {
+        if (auto it = strings_.find(strs[i]); it != strings_.end()) {
+            result[i] = it->first;
+            hold(it->second);
+        } else {
+            missing.push_back(i);
+            missing_size += strs[i].size();
+        }
+    }
+    if (missing.empty()) {
+        return result;
+    }
+
+    auto chunk = std::make_unique<Chunk>();
+    chunk->data = std::make_unique<char[]>(missing_size);
+    char* dest = chunk->data.get();
+    for (size_t i : missing) {
+        // strs may repeat a string
+        if (auto it = strings_.find(strs[i]); it != strings_.end()) {
+            result[i] = it->first;
+            continue;
+        }
+        std::memcpy(dest, strs[i].data(), strs[i].size());
+        result[i] = std::string_view(dest, strs[i].size());
+        dest += strs[i].size();
+        chunk->strings.push_back(result[i]);
+        strings_.emplace(result[i], chunk.get());
+    }
+    chunk->size = dest - chunk->data.get();
+    bytes_used_ += chunk->size;
+    hold(chunk.get());
+    Chunk* key = chunk.get();
+    chunks_.emplace(key, std::move(chunk));
+    return result;
+}
+
+void SharedStringArena::Release(const std::vector<Chunk*>& held) {
+    std::lock_guard guard(mutex_);
+    for (Chunk* chunk : held) {
+        if (--chunk->holders > 0) {
+            continue;
+        }
+        for (std::string_view str : chunk->strings) {
+            strings_.erase(str);
+        }
+        bytes_used_ -= chunk->size;
+        chunks_.erase(chunk);
+    }
+}
+
+size_t SharedStringArena::GetStringsCount() const {
+    std::lock_guard guard(mutex_);
+    return strings_.size();
+}
+
+size_t SharedStringArena::GetBytesUsed() const {
+    std::lock_guard guard(mutex_);
+    return bytes_used_;
+}
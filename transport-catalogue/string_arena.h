@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Strings of several StringArenas at once, e.g. of the catalogues of different cities, each stored once.
+// The strings taken in one Acquire are copied into one chunk, and a chunk is freed whole once no arena
+// holds it, so a city unloaded and loaded again leaves nothing behind.
+class SharedStringArena {
+public:
+    struct Chunk;
+
+    SharedStringArena();
+    SharedStringArena(const SharedStringArena&) = delete;
+    SharedStringArena& operator=(const SharedStringArena&) = delete;
+    ~SharedStringArena();
+
+    // the stored copies of strs, in the same order; the chunks they live in are added to held
+    // (each once) and stay valid until Release(held)
+    std::vector<std::string_view> Acquire(const std::vector<std::string_view>& strs, std::vector<Chunk*>& held);
+    void Release(const std::vector<Chunk*>& held);
+
+    size_t GetStringsCount() const;
+    size_t GetBytesUsed() const;
+
+private:
+    mutable std::mutex mutex_;
+    // keyed by views into the chunks
+    std::unordered_map<std::string_view, Chunk*> strings_;
+    std::unordered_map<Chunk*, std::unique_ptr<Chunk>> chunks_;
+    size_t bytes_used_ = 0;
+};
+
+// Interning storage for stop and bus names: every distinct string is kept exactly once,
+// packed into large blocks, and handed out as a string_view that stays valid for the arena's lifetime
+// (including after the arena itself is moved).
+class StringArena {
+public:
+    StringArena() = default;
+    // keeps the strings in shared instead, each held there until this arena goes away
+    explicit StringArena(std::shared_ptr<SharedStringArena> shared);
+    StringArena(StringArena&& other) noexcept;
+    StringArena& operator=(StringArena&& other) noexcept;
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+    ~StringArena();
+
+    std::string_view Intern(std::string_view str);
+    // Intern for each of strs; an arena over a SharedStringArena takes the shared lock once for all of them
+    void InternAll(const std::vector<std::string_view>& strs);
+    bool Contains(std::string_view str) const;
+    // room for strings_count distinct strings without rehashing
+    void Reserve(size_t strings_count);
+
+    size_t GetStringsCount() const;
+    size_t GetBytesUsed() const;
+
+private:
+    std::string_view Store(std::string_view str);
+    void ReleaseShared();
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    size_t block_used_ = 0;
+    size_t block_capacity_ = 0;
+    size_t bytes_used_ = 0;
+    std::unordered_set<std::string_view> interned_;
+    std::shared_ptr<SharedStringArena> shared_;
+    std::vector<SharedStringArena::Chunk*> shared_chunks_;
+};
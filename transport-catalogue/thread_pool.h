@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads taking tasks in submission order.
+// The destructor finishes the queued tasks and joins the workers.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads_count);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    template <typename Task>
+    auto Submit(Task task) -> std::future<std::invoke_result_t<Task>>;
+
+    size_t GetThreadsCount() const;
+
+private:
+    void Work();
+
+    std::mutex mutex_;
+    std::condition_variable has_tasks_;
+    std::deque<std::function<void()>> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+template <typename Task>
+auto ThreadPool::Submit(Task task) -> std::future<std::invoke_result_t<Task>> {
+    // std::function needs a copyable target, packaged_task is move-only
+    auto packaged = std::make_shared<std::packaged_task<std::invoke_result_t<Task>()>>(std::move(task));
+    auto result = packaged->get_future();
+    {
+        std::lock_guard guard(mutex_);
+        tasks_.emplace_back([packaged] {
+            (*packaged)();
+        });
+    }
+    has_tasks_.notify_one();
+    return result;
+}
@@ -1,13 +1,25 @@
 #include "transport_catalogue.h"
 
+#include <cmath>
+#include <future>
+
 using namespace std;
 
 namespace tc {
 
     void TransportCatalogue::AddStop(const Stop& stop) {
-        const auto& link = stops_.emplace_back(stop);
+        AddStop(Stop(stop));
+    }
+
+    void TransportCatalogue::AddStop(Stop&& stop) {
+        auto& link = stops_.emplace_back(std::move(stop));
+        link.name = names_.Intern(link.name);
+        for (auto& [stop_to, distance] : link.road_distances) {
+            stop_to = names_.Intern(stop_to);
+        }
         names_stops_[link.name] = &link;
         stops_index[&link] = stops_index.size();
+        frozen_ = false;
     }
 
     size_t TransportCatalogue::GetStopIndex(const Stop* stop) const {
@@ -24,13 +36,18 @@ namespace tc {
     }
 
     void TransportCatalogue::AddBus(const Bus& bus) {
-        const auto& link = buses_.emplace_back(bus);
-        names_buses_[link.name] = &link;
+        AddBus(Bus(bus));
+    }
 
-        for (const auto& stop_name : link.stops) {
-            const Stop* stop = GetStopByName(stop_name);
-            stop_to_buses_[stop].insert(link.name);
+    void TransportCatalogue::AddBus(Bus&& bus) {
+        auto& link = buses_.emplace_back(std::move(bus));
+        buses_index_[&link] = buses_.size() - 1;
+        link.name = names_.Intern(link.name);
+        for (auto& stop_name : link.stops) {
+            stop_name = names_.Intern(stop_name);
         }
+        names_buses_[link.name] = &link;
+        frozen_ = false;
     }
 
     void TransportCatalogue::FillTransportBase(const std::deque<Stop>& stops, const std::deque<Bus>& buses) {
@@ -43,9 +60,380 @@ namespace tc {
         for (auto& bus : buses) {
             AddBus(bus);
         }
+        Freeze();
+    }
+
+    void TransportCatalogue::FillTransportBase(std::shared_ptr<SharedStringArena> names, std::deque<Stop>&& stops, std::deque<Bus>&& buses) {
+        // all the names at once, so parallel loads into the same shared arena lock it once per city
+        vector<string_view> all_names;
+        for (const Stop& stop : stops) {
+            all_names.push_back(stop.name);
+            for (const auto& [stop_to, distance] : stop.road_distances) {
+                all_names.push_back(stop_to);
+            }
+        }
+        for (const Bus& bus : buses) {
+            all_names.push_back(bus.name);
+            all_names.insert(all_names.end(), bus.stops.begin(), bus.stops.end());
+        }
+        StringArena shared_names(std::move(names));
+        shared_names.InternAll(all_names);
+        FillTransportBase(std::move(shared_names), std::move(stops), std::move(buses));
+    }
+
+    void TransportCatalogue::FillTransportBase(StringArena&& names, std::deque<Stop>&& stops, std::deque<Bus>&& buses) {
+        if (stops_.empty() && buses_.empty()) {
+            // the parsed names become ours, so interning below only finds them again
+            names_ = std::move(names);
+        }
+
+        size_t distances_count = 0;
+        for (const Stop& stop : stops) {
+            distances_count += stop.road_distances.size();
+        }
+
+        const size_t stops_count = stops_.size() + stops.size();
+        names_stops_.reserve(stops_count);
+        stops_index.reserve(stops_count);
+        names_buses_.reserve(buses_.size() + buses.size());
+        buses_index_.reserve(buses_.size() + buses.size());
+        stops_distance_.reserve(stops_distance_.size() + distances_count);
+
+        const size_t first_new_stop = stops_.size();
+        for (Stop& stop : stops) {
+            AddStop(std::move(stop));
+        }
+        for (size_t i = first_new_stop; i < stops_.size(); ++i) {
+            SetDistance(stops_[i]);
+        }
+        for (Bus& bus : buses) {
+            AddBus(std::move(bus));
+        }
+        stops.clear();
+        buses.clear();
+        Freeze();
+    }
+
+    void TransportCatalogue::SetDistanceFormula(geo::DistanceFormula formula) {
+        distance_formula_ = formula;
+        frozen_ = false;
+    }
+
+    void TransportCatalogue::SetFreezeThreadsCount(size_t threads_count) {
+        freeze_threads_count_ = threads_count;
+    }
+
+    void TransportCatalogue::Freeze() {
+        vector<NameIndex::Entry> names;
+        names.reserve(stops_.size());
+        for (size_t id = 0; id < stops_.size(); ++id) {
+            if (names_stops_.at(stops_[id].name) == &stops_[id]) {
+                names.emplace_back(stops_[id].name, id);
+            }
+        }
+        stop_names_indexed_ = stop_names_index_.Build(names);
+
+        names.clear();
+        for (size_t id = 0; id < buses_.size(); ++id) {
+            if (names_buses_.at(buses_[id].name) == &buses_[id]) {
+                names.emplace_back(buses_[id].name, id);
+            }
+        }
+        bus_names_indexed_ = bus_names_index_.Build(names);
+
+        vector<string_view> trie_names;
+        trie_names.reserve(stops_.size());
+        for (const Stop& stop : stops_) {
+            trie_names.push_back(stop.name);
+        }
+        stop_names_trie_.Build(move(trie_names));
+
+        trie_names.clear();
+        trie_names.reserve(buses_.size());
+        for (const Bus& bus : buses_) {
+            trie_names.push_back(bus.name);
+        }
+        bus_names_trie_.Build(move(trie_names));
+
+        stop_coordinates_.resize(stops_.size());
+        for (size_t id = 0; id < stops_.size(); ++id) {
+            stop_coordinates_[id] = geo::Prepare(stops_[id].position);
+        }
+
+        frozen_ = true;
+        BuildBusTables();
+        BuildStopToBuses();
+        BuildStopsGrid();
+        BuildColumns();
+    }
+
+    void TransportCatalogue::BuildColumns() {
+        columns_.Clear();
+        columns_.Reserve(stops_.size(), buses_.size());
+        for (size_t id = 0; id < stops_.size(); ++id) {
+            columns_.AddStop(stops_[id], stop_buses_offsets_[id + 1] - stop_buses_offsets_[id]);
+        }
+
+        vector<uint32_t> stop_ids;
+        for (size_t id = 0; id < buses_.size(); ++id) {
+            stop_ids.clear();
+            for (const Stop* stop : bus_routes_[id].stops) {
+                stop_ids.push_back(static_cast<uint32_t>(GetStopIndex(stop)));
+            }
+            columns_.AddBus(buses_[id], bus_stats_[id], stop_ids);
+        }
+    }
+
+    void TransportCatalogue::BuildStopsGrid() {
+        vector<geo::Coordinates> positions;
+        positions.reserve(stops_.size());
+        for (const Stop& stop : stops_) {
+            positions.push_back(stop.position);
+        }
+        stops_grid_.Build(positions);
+    }
+
+    void TransportCatalogue::BuildStopToBuses() {
+        vector<uint32_t> bus_rank(buses_.size());
+        {
+            vector<uint32_t> order(buses_.size());
+            iota(order.begin(), order.end(), 0);
+            sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) {
+                return buses_[lhs].name < buses_[rhs].name;
+            });
+            for (uint32_t rank = 0; rank < order.size(); ++rank) {
+                bus_rank[order[rank]] = rank;
+            }
+        }
+
+        // (stop id, bus rank) for every stop of every bus, then sorted and deduplicated
+        vector<pair<uint32_t, uint32_t>> visits;
+        for (size_t bus_id = 0; bus_id < buses_.size(); ++bus_id) {
+            for (const Stop* stop : bus_routes_[bus_id].stops) {
+                visits.emplace_back(static_cast<uint32_t>(GetStopIndex(stop)), bus_rank[bus_id]);
+            }
+        }
+        sort(visits.begin(), visits.end());
+        visits.erase(unique(visits.begin(), visits.end()), visits.end());
+
+        vector<uint32_t> bus_by_rank(buses_.size());
+        for (uint32_t bus_id = 0; bus_id < buses_.size(); ++bus_id) {
+            bus_by_rank[bus_rank[bus_id]] = bus_id;
+        }
+
+        stop_buses_offsets_.assign(stops_.size() + 1, 0);
+        stop_buses_.clear();
+        stop_buses_.reserve(visits.size());
+        for (const auto& [stop_id, rank] : visits) {
+            ++stop_buses_offsets_[stop_id + 1];
+            stop_buses_.push_back(&buses_[bus_by_rank[rank]]);
+        }
+        partial_sum(stop_buses_offsets_.begin(), stop_buses_offsets_.end(), stop_buses_offsets_.begin());
+    }
+
+    void TransportCatalogue::BuildBusTables() {
+        constexpr size_t MIN_BUSES_PER_TASK = 64;
+
+        bus_routes_.assign(buses_.size(), BusRoute{});
+        bus_stats_.assign(buses_.size(), BusStat{});
+
+        const auto build = [this](size_t begin, size_t end) {
+            for (size_t id = begin; id < end; ++id) {
+                bus_routes_[id] = BuildBusRoute(buses_[id]);
+                bus_stats_[id] = ComputeBusStat(buses_[id], bus_routes_[id]);
+            }
+        };
+
+        const size_t tasks_count = max<size_t>(1, min<size_t>(freeze_threads_count_, buses_.size() / MIN_BUSES_PER_TASK));
+        if (tasks_count == 1) {
+            build(0, buses_.size());
+            return;
+        }
+        const size_t chunk = (buses_.size() + tasks_count - 1) / tasks_count;
+
+        vector<future<void>> tasks;
+        for (size_t begin = 0; begin < buses_.size(); begin += chunk) {
+            tasks.push_back(async(launch::async, build, begin, min(buses_.size(), begin + chunk)));
+        }
+        for (auto& task : tasks) {
+            task.get();
+        }
+    }
+
+    TransportCatalogue::BusRoute TransportCatalogue::BuildBusRoute(const Bus& bus) const {
+        BusRoute route;
+        route.stops.reserve(bus.stops.size());
+        // once frozen, hop lengths come from the prepared coordinates in one batch
+        vector<geo::PreparedCoordinates> points;
+        vector<double> hops;
+        if (frozen_) {
+            points.reserve(bus.stops.size());
+            for (string_view stop_name : bus.stops) {
+                const size_t id = FindStopId(stop_name).value();
+                route.stops.push_back(&stops_[id]);
+                points.push_back(stop_coordinates_[id]);
+            }
+            hops.resize(points.empty() ? 0 : points.size() - 1);
+            geo::ComputeDistances(points.data(), points.data() + 1, hops.size(), hops.data(), distance_formula_);
+        } else {
+            for (string_view stop_name : bus.stops) {
+                route.stops.push_back(GetStopByName(stop_name));
+            }
+        }
+
+        route.road_forward.reserve(route.stops.size());
+        route.gps.reserve(route.stops.size());
+        route.road_forward.push_back(0);
+        route.gps.push_back(0.0);
+        if (!bus.is_roundtrip) {
+            route.road_backward.reserve(route.stops.size());
+            route.road_backward.push_back(0);
+        }
+
+        for (size_t i = 1; i < route.stops.size(); ++i) {
+            const Stop* stop_prev = route.stops[i - 1];
+            const Stop* stop_next = route.stops[i];
+            route.road_forward.push_back(route.road_forward.back() + GetDistanceBetweenStops(stop_prev, stop_next).value());
+            if (!bus.is_roundtrip) {
+                route.road_backward.push_back(route.road_backward.back() + GetDistanceBetweenStops(stop_next, stop_prev).value());
+            }
+            route.gps.push_back(route.gps.back() + (frozen_ ? hops[i - 1] : geo::ComputeDistance(stop_prev->position, stop_next->position)));
+        }
+
+        return route;
+    }
+
+    // road length from the start of the ride to the given position
+    int TransportCatalogue::GetRideRoadLength(const Bus& bus, const BusRoute& route, size_t position) const {
+        const size_t last = route.stops.size() - 1;
+        if (bus.is_roundtrip || position <= last) {
+            return route.road_forward[position];
+        }
+        return route.road_forward.back() + route.road_backward.back() - route.road_backward[2 * last - position];
+    }
+
+    double TransportCatalogue::GetRideGPSLength(const Bus& bus, const BusRoute& route, size_t position) const {
+        const size_t last = route.stops.size() - 1;
+        if (bus.is_roundtrip || position <= last) {
+            return route.gps[position];
+        }
+        return 2 * route.gps.back() - route.gps[2 * last - position];
+    }
+
+    optional<size_t> TransportCatalogue::FindStopId(string_view stop_name) const {
+        if (stop_names_indexed_) {
+            return stop_names_index_.Find(stop_name, [this](size_t id) {
+                return stops_[id].name;
+            });
+        }
+        const auto it = names_stops_.find(stop_name);
+        if (it == names_stops_.end()) {
+            return nullopt;
+        }
+        return stops_index.at(it->second);
+    }
+
+    optional<size_t> TransportCatalogue::FindBusId(string_view bus_name) const {
+        if (bus_names_indexed_) {
+            return bus_names_index_.Find(bus_name, [this](size_t id) {
+                return buses_[id].name;
+            });
+        }
+        const auto it = names_buses_.find(bus_name);
+        if (it == names_buses_.end()) {
+            return nullopt;
+        }
+        return buses_index_.at(it->second);
+    }
+
+    optional<BusStat> TransportCatalogue::GetBusStat(string_view bus_name) const {
+        if (frozen_) {
+            const auto id = FindBusId(bus_name);
+            if (!id) {
+                return nullopt;
+            }
+            return bus_stats_[*id];
+        }
+
+        const Bus* bus = GetRouteByBusName(bus_name);
+        if (bus == nullptr) {
+            return nullopt;
+        }
+        return ComputeBusStat(*bus, BuildBusRoute(*bus));
+    }
+
+    optional<SegmentStat> TransportCatalogue::GetSegmentStat(const Bus* bus, size_t from_position, size_t to_position) const {
+        if (!frozen_ || bus == nullptr || from_position > to_position) {
+            return nullopt;
+        }
+        // a non-roundtrip bus without stops counts -1 of them
+        const int stops_count = CalculateStopCount(*bus);
+        if (stops_count <= 0 || to_position >= static_cast<size_t>(stops_count)) {
+            return nullopt;
+        }
+
+        const BusRoute& route = bus_routes_[GetBusIndex(bus)];
+        SegmentStat segment;
+        segment.route_length = GetRideRoadLength(*bus, route, to_position) - GetRideRoadLength(*bus, route, from_position);
+        segment.gps_length = GetRideGPSLength(*bus, route, to_position) - GetRideGPSLength(*bus, route, from_position);
+        return segment;
+    }
+
+    const vector<const Stop*>& TransportCatalogue::GetBusStops(const Bus* bus) const {
+        return bus_routes_.at(GetBusIndex(bus)).stops;
+    }
+
+    size_t TransportCatalogue::GetBusIndex(const Bus* bus) const {
+        return buses_index_.at(bus);
+    }
+
+    BusStat TransportCatalogue::ComputeBusStat(const Bus& bus, const BusRoute& route) const {
+        BusStat bus_stat;
+        bus_stat.bus_name = bus.name;
+        if (route.stops.empty()) {
+            return bus_stat;
+        }
+        bus_stat.stops_count = CalculateStopCount(bus);
+        bus_stat.unique_stops = CalculateUniqueStops(route);
+        bus_stat.length = GetRideRoadLength(bus, route, bus_stat.stops_count - 1);
+        const double gps_length = bus.is_roundtrip ? route.gps.back() : 2 * route.gps.back();
+        bus_stat.curvature = CalculateCurvature(bus_stat.length, gps_length);
+        return bus_stat;
+    }
+
+    double TransportCatalogue::CalculateCurvature(double bus_route_length, double gps_length) const {
+        constexpr double EPSILON = 1e-6;
+
+        if (std::abs(gps_length) < EPSILON) {
+            return 0.0;
+        } else {
+            return bus_route_length / gps_length;
+        }
+    }
+
+    int TransportCatalogue::CalculateUniqueStops(const BusRoute& route) const {
+        vector<const Stop*> unique_stops(route.stops);
+        sort(unique_stops.begin(), unique_stops.end());
+
+        return static_cast<int>(unique(unique_stops.begin(), unique_stops.end()) - unique_stops.begin());
+    }
+
+    int TransportCatalogue::CalculateStopCount(const Bus& bus) const {
+        int stops_count = static_cast<int>(bus.stops.size());
+
+        if (!bus.is_roundtrip) {
+            stops_count = 2 * stops_count - 1;
+        }
+
+        return stops_count;
     }
 
     const Bus* TransportCatalogue::GetRouteByBusName(std::string_view bus_name) const {
+        if (frozen_) {
+            const auto id = FindBusId(bus_name);
+            return id ? &buses_[*id] : nullptr;
+        }
+
         auto it = names_buses_.find(bus_name);
 
         if (it != names_buses_.end()) {
@@ -56,6 +444,11 @@ namespace tc {
     } 
 
     const Stop* TransportCatalogue::GetStopByName(std::string_view stop_name) const {
+        if (frozen_) {
+            const auto id = FindStopId(stop_name);
+            return id ? &stops_[*id] : nullptr;
+        }
+
         auto it = names_stops_.find(stop_name);
 
         if (it != names_stops_.end()) {
@@ -65,16 +458,40 @@ namespace tc {
         }
     } 
 
-    const set<string_view>& TransportCatalogue::GetBusesToStop(const Stop* stop) const {
-        const static set<string_view> empty_set;
+    BusesRange TransportCatalogue::GetBusesToStop(const Stop* stop) const {
+        if (!frozen_ || stop == nullptr) {
+            return {stop_buses_.end(), stop_buses_.end()};
+        }
 
-        auto it = stop_to_buses_.find(stop);
+        const size_t stop_id = GetStopIndex(stop);
+        return {stop_buses_.begin() + stop_buses_offsets_[stop_id], stop_buses_.begin() + stop_buses_offsets_[stop_id + 1]};
+    }
 
-        if (it == stop_to_buses_.end()) {
-            return empty_set;
+    vector<StopDistance> TransportCatalogue::GetNearestStops(geo::Coordinates point, size_t count) const {
+        vector<StopDistance> result;
+        if (!frozen_) {
+            return result;
         }
 
-        return it->second;
+        for (const auto& [id, distance] : stops_grid_.FindNearest(point, count)) {
+            result.push_back({&stops_[id], distance});
+        }
+        return result;
+    }
+
+    vector<const Stop*> TransportCatalogue::GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const {
+        vector<const Stop*> result;
+        if (!frozen_) {
+            return result;
+        }
+
+        for (size_t id : stops_grid_.FindInBox(min, max)) {
+            result.push_back(&stops_[id]);
+        }
+        sort(result.begin(), result.end(), [](const Stop* lhs, const Stop* rhs) {
+            return lhs->name < rhs->name;
+        });
+        return result;
     }
 
     std::optional<int> TransportCatalogue::GetDistanceBetweenStops(const Stop* stop_from, const Stop* stop_to) const {
@@ -101,6 +518,28 @@ namespace tc {
         return buses_;
     }
 
+    vector<NameTrie::Match> TransportCatalogue::SearchStopNames(string_view query, size_t count, bool fuzzy) const {
+        if (!frozen_) {
+            return {};
+        }
+        return stop_names_trie_.Search(query, count, fuzzy);
+    }
+
+    vector<NameTrie::Match> TransportCatalogue::SearchBusNames(string_view query, size_t count, bool fuzzy) const {
+        if (!frozen_) {
+            return {};
+        }
+        return bus_names_trie_.Search(query, count, fuzzy);
+    }
+
+    const NetworkColumns& TransportCatalogue::GetColumns() const {
+        return columns_;
+    }
+
+    const StringArena& TransportCatalogue::GetNames() const {
+        return names_;
+    }
+
     size_t TransportCatalogue::GetAllStopsCount() const {
         return stops_index.size();
     }
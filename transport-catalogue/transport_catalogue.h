@@ -2,50 +2,148 @@
 
 #include "domain.h"
 #include "geo.h"
+#include "name_index.h"
+#include "name_trie.h"
+#include "network_columns.h"
+#include "spatial_index.h"
+#include "string_arena.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <deque>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 namespace tc {
 
     struct HasherForPair {
         template <class T1, class T2>
         std::size_t operator()(const std::pair<T1, T2>& ab) const {
-            return std::hash<T1>()(ab.first) + 37 * std::hash<T2>()(ab.second);
+            std::size_t hash = std::hash<T1>()(ab.first);
+            hash ^= std::hash<T2>()(ab.second) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+            return hash;
         }
     };
 
     class TransportCatalogue {
     public:
         void AddBus(const Bus& bus);
+        void AddBus(Bus&& bus);
         void AddStop(const Stop& stop);
+        void AddStop(Stop&& stop);
         void SetDistance(const Stop& stop);
         void FillTransportBase(const std::deque<Stop>& stops, const std::deque<Bus>& buses);
+        // bulk load: takes over the parsed names and moves stops and buses in, with every index pre-sized
+        void FillTransportBase(StringArena&& names, std::deque<Stop>&& stops, std::deque<Bus>&& buses);
+        // bulk load with the names kept in an arena shared with other catalogues, released when this one goes away
+        void FillTransportBase(std::shared_ptr<SharedStringArena> names, std::deque<Stop>&& stops, std::deque<Bus>&& buses);
+        // formula for the GPS lengths computed by the next Freeze(); COSINES matches geo::ComputeDistance
+        void SetDistanceFormula(geo::DistanceFormula formula);
+        // threads the next Freeze() may build the bus tables on; 1 keeps it on the calling thread
+        void SetFreezeThreadsCount(size_t threads_count);
+        void Freeze();
         const Bus* GetRouteByBusName(std::string_view bus_name) const;
         const Stop* GetStopByName(std::string_view stop_name) const;
-        const std::set<std::string_view>& GetBusesToStop(const Stop* stop) const;
+        // served from the table built by Freeze(), computed on the fly before that
+        std::optional<BusStat> GetBusStat(std::string_view bus_name) const;
+        // positions count stops along the whole ride (there and back for non-roundtrip buses),
+        // from_position <= to_position; O(1) from prefix sums built by Freeze()
+        std::optional<SegmentStat> GetSegmentStat(const Bus* bus, size_t from_position, size_t to_position) const;
+        const std::vector<const Stop*>& GetBusStops(const Bus* bus) const;
+        // buses serving the stop, sorted by name; a view into the index built by Freeze()
+        BusesRange GetBusesToStop(const Stop* stop) const;
+        // grid lookups, empty until Freeze(): closest first / sorted by name
+        std::vector<StopDistance> GetNearestStops(geo::Coordinates point, size_t count) const;
+        std::vector<const Stop*> GetStopsInBox(geo::Coordinates min, geo::Coordinates max) const;
+        // calls action(stop, other_stop, distance) once for every pair of stops within radius metres
+        template <typename Action>
+        void ForEachStopPairWithin(double radius, Action action) const;
         std::optional<int> GetDistanceBetweenStops(const Stop* stop_from, const Stop* stop_to) const;
         const std::deque<Stop>& GetStops() const;
         const std::deque<Bus>& GetBuses() const;
         size_t GetAllStopsCount() const;
         size_t GetStopIndex(const Stop* stop) const;
+        size_t GetBusIndex(const Bus* bus) const;
+        const StringArena& GetNames() const;
+        // autocomplete over the names, empty until Freeze(); see NameTrie::Search
+        std::vector<NameTrie::Match> SearchStopNames(std::string_view query, size_t count, bool fuzzy) const;
+        std::vector<NameTrie::Match> SearchBusNames(std::string_view query, size_t count, bool fuzzy) const;
+        // columnar copy for network-wide scans, built by Freeze()
+        const NetworkColumns& GetColumns() const;
 
     private:
+        // stops of a bus as listed, with prefix sums of the hop lengths
+        struct BusRoute {
+            std::vector<const Stop*> stops;
+            std::vector<int> road_forward;
+            std::vector<int> road_backward;
+            std::vector<double> gps;
+        };
+
+        // ids by the perfect hash, or by the name maps in the rare case it could not be built
+        std::optional<size_t> FindStopId(std::string_view stop_name) const;
+        std::optional<size_t> FindBusId(std::string_view bus_name) const;
+        BusRoute BuildBusRoute(const Bus& bus) const;
+        int GetRideRoadLength(const Bus& bus, const BusRoute& route, size_t position) const;
+        double GetRideGPSLength(const Bus& bus, const BusRoute& route, size_t position) const;
+        BusStat ComputeBusStat(const Bus& bus, const BusRoute& route) const;
+        int CalculateStopCount(const Bus& bus) const;
+        int CalculateUniqueStops(const BusRoute& route) const;
+        double CalculateCurvature(double bus_route_length, double gps_length) const;
+        void BuildBusTables();
+        void BuildStopToBuses();
+        void BuildStopsGrid();
+        void BuildColumns();
+
+        // possibly backed by an arena shared with other catalogues
+        StringArena names_;
         std::unordered_map<const Stop*, size_t> stops_index;
+        std::unordered_map<const Bus*, size_t> buses_index_;
         std::deque<Stop> stops_;
         std::deque<Bus> buses_;
 
         std::unordered_map<std::string_view, const Stop*> names_stops_;
         std::unordered_map<std::string_view, const Bus*> names_buses_;
 
-        std::unordered_map<const Stop*, std::set<std::string_view>> stop_to_buses_;
+        bool frozen_ = false;
+        NameIndex stop_names_index_;
+        NameIndex bus_names_index_;
+        bool stop_names_indexed_ = false;
+        bool bus_names_indexed_ = false;
+        NameTrie stop_names_trie_;
+        NameTrie bus_names_trie_;
+        geo::DistanceFormula distance_formula_ = geo::DistanceFormula::COSINES;
+        size_t freeze_threads_count_ = std::thread::hardware_concurrency();
+        // stop positions with the trigonometry done, by stop id
+        std::vector<geo::PreparedCoordinates> stop_coordinates_;
+        std::vector<BusRoute> bus_routes_;
+        std::vector<BusStat> bus_stats_;
+
+        // buses of stop i are stop_buses_[stop_buses_offsets_[i] .. stop_buses_offsets_[i + 1])
+        std::vector<uint32_t> stop_buses_offsets_;
+        std::vector<const Bus*> stop_buses_;
+        // stop ids are positions in stops_
+        geo::PointGrid stops_grid_;
+        NetworkColumns columns_;
         std::unordered_map<std::pair<const Stop*, const Stop*>, int, HasherForPair> stops_distance_;
     };
+
+    template <typename Action>
+    void TransportCatalogue::ForEachStopPairWithin(double radius, Action action) const {
+        if (!frozen_) {
+            return;
+        }
+
+        stops_grid_.ForEachPairWithin(radius, [this, &action](size_t id, size_t other_id, double distance) {
+            action(&stops_[id], &stops_[other_id], distance);
+        });
+    }
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "transport_router.h"
 
+#include <cmath>
+
 using namespace std;
 
-void TransportRouter::DistanceToEdge(map_pair_distance pair_distance){
+void TransportRouter::DistanceToEdge(const map_pair_distance& pair_distance){
     for (const auto& [stops_indexes, props] : pair_distance) {
 
         double travel_time = double(props.distance) / routing_settings_.bus_velocity + double(routing_settings_.bus_wait_time);
@@ -13,77 +15,77 @@ void TransportRouter::DistanceToEdge(map_pair_distance pair_distance){
     }
 }
 
-int TransportRouter::GetDistanceFromTo(const Stop* prev_stop, const Stop* current_stop, graph::VertexId vid_stop_from, graph::VertexId prev_stop_to) {
-    
-    auto distance_prev_current = transport_catalogue_.GetDistanceBetweenStops(prev_stop, current_stop); 
-    int distance = pair_n_distance_.at({ vid_stop_from, prev_stop_to }) + distance_prev_current.value();
-    
-    return distance;
+namespace {
+    void KeepShortestEdge(map_pair_distance& pair_distance, std::pair<graph::VertexId, graph::VertexId> stops_indexes, const EdgeProps& edge_prop) {
+        auto it_find = pair_distance.find(stops_indexes);
+
+        if (it_find == pair_distance.end()) {
+            pair_distance.emplace(stops_indexes, edge_prop);
+        } else if (it_find->second.distance > edge_prop.distance) {
+            it_find->second = edge_prop;
+        }
+    }
 }
 
 void TransportRouter::CreateGraph() {
     map_pair_distance pair_distance;
 
-    graph::VertexId vid_stop_from = 0;
-    graph::VertexId prev_stop_to = 0;
-    graph::VertexId current_stop_to = 0;
-
     for (const Bus& bus : transport_catalogue_.GetBuses()) {
-        for (auto it_outer = bus.stops.begin(); it_outer + 1 != bus.stops.end(); ++it_outer) {
-            int span_count = 0;
-            const Stop* stop_from = transport_catalogue_.GetStopByName(*it_outer);
-            vid_stop_from = transport_catalogue_.GetStopIndex(stop_from);
-            int zero_stop_distance = 0;
-            pair_n_distance_[{ vid_stop_from, vid_stop_from }] = zero_stop_distance;
-            for (auto it_inner = it_outer + 1; it_inner != bus.stops.end(); ++it_inner) {
-                ++span_count;
-                const Stop* prev_stop = transport_catalogue_.GetStopByName(*std::prev(it_inner));
-                const Stop* current_stop = transport_catalogue_.GetStopByName(*it_inner);
-                prev_stop_to = transport_catalogue_.GetStopIndex(prev_stop);
-                current_stop_to = transport_catalogue_.GetStopIndex(current_stop);
-                
-                int distance_from_to_current = GetDistanceFromTo(prev_stop, current_stop, vid_stop_from, prev_stop_to); 
-                
-                pair_n_distance_[{ vid_stop_from, current_stop_to }] = distance_from_to_current;
+        const auto& stops = transport_catalogue_.GetBusStops(&bus);
+        // on a non-roundtrip bus the way back from stop j is ride position last_position - j
+        const size_t last_position = 2 * (stops.size() - 1);
+
+        for (size_t from = 0; from + 1 < stops.size(); ++from) {
+            const graph::VertexId vid_stop_from = transport_catalogue_.GetStopIndex(stops[from]);
+
+            for (size_t to = from + 1; to < stops.size(); ++to) {
+                const graph::VertexId vid_stop_to = transport_catalogue_.GetStopIndex(stops[to]);
+
                 EdgeProps edge_prop;
                 edge_prop.bus = &bus;
-                edge_prop.span_count = span_count;
-                edge_prop.distance = distance_from_to_current;
+                edge_prop.span_count = static_cast<int>(to - from);
+                edge_prop.distance = transport_catalogue_.GetSegmentStat(&bus, from, to)->route_length;
                 edge_prop.travel_time = 0.0;
-                edge_prop.stop_from = *it_outer;
-                
-                auto it_find = pair_distance.find({ vid_stop_from, current_stop_to });
-
-                if (it_find == pair_distance.end()) {
-                    pair_distance[{ vid_stop_from, current_stop_to }] = edge_prop;
-                } else if (it_find->second.distance > distance_from_to_current) {
-                    pair_distance[{ vid_stop_from, current_stop_to }] = edge_prop;
-                }
+                edge_prop.stop_from = stops[from]->name;
+                edge_prop.stop_to = stops[to]->name;
+                KeepShortestEdge(pair_distance, { vid_stop_from, vid_stop_to }, edge_prop);
 
                 if (!bus.is_roundtrip) {
-                    
-                    int distance_current_to_from = GetDistanceFromTo(current_stop, prev_stop, prev_stop_to, vid_stop_from); 
-                    
-                    pair_n_distance_[{ current_stop_to, vid_stop_from }] = distance_current_to_from;
-                    
                     EdgeProps edge_prop_rev(edge_prop);
-                    edge_prop_rev.distance = distance_current_to_from;
-                    edge_prop_rev.stop_from = *it_inner;
-                    
-                    auto it_find_rev = pair_distance.find({ current_stop_to, vid_stop_from });
-
-                    if (it_find_rev == pair_distance.end()) {
-                        pair_distance[{ current_stop_to, vid_stop_from }] = edge_prop_rev;
-                    } else if (it_find_rev->second.distance > distance_current_to_from) {
-                        pair_distance[{ current_stop_to, vid_stop_from }] = edge_prop_rev;
-                    }
+                    edge_prop_rev.distance = transport_catalogue_.GetSegmentStat(&bus, last_position - to, last_position - from)->route_length;
+                    edge_prop_rev.stop_from = stops[to]->name;
+                    edge_prop_rev.stop_to = stops[from]->name;
+                    KeepShortestEdge(pair_distance, { vid_stop_to, vid_stop_from }, edge_prop_rev);
                 }
             }
         }
+    }
 
-        DistanceToEdge(pair_distance);
-        
+    DistanceToEdge(pair_distance);
+    AddWalkingEdges();
+    components_ = graph::Components(routes_graph_);
+}
+
+const graph::Components& TransportRouter::GetComponents() const {
+    return components_;
+}
+
+void TransportRouter::AddWalkingEdges() {
+    if (routing_settings_.walk_transfer_distance <= 0.0) {
+        return;
     }
+
+    transport_catalogue_.ForEachStopPairWithin(routing_settings_.walk_transfer_distance, [this](const Stop* stop, const Stop* other_stop, double distance) {
+        const graph::VertexId vid_stop = transport_catalogue_.GetStopIndex(stop);
+        const graph::VertexId vid_other_stop = transport_catalogue_.GetStopIndex(other_stop);
+        const double walk_time = distance / routing_settings_.walk_velocity;
+
+        EdgeProps edge_prop{nullptr, 0, static_cast<int>(std::lround(distance)), walk_time, stop->name, other_stop->name};
+        edgeID_n_edge_props_.emplace(routes_graph_.AddEdge({ vid_stop, vid_other_stop, walk_time }), edge_prop);
+
+        std::swap(edge_prop.stop_from, edge_prop.stop_to);
+        edgeID_n_edge_props_.emplace(routes_graph_.AddEdge({ vid_other_stop, vid_stop, walk_time }), edge_prop);
+    });
 }
 
 const EdgeProps& TransportRouter::GetEdgeProps(graph::EdgeId id) const {
@@ -108,6 +110,19 @@ const RouteStat TransportRouter::GetRoute(RoutingSettings routing_settings, std:
 
     for (const auto& edgeID : edges) {
         EdgeProps props = transport_router.GetEdgeProps(edgeID);
+        if (props.bus == nullptr) {
+            RouteElement walk_element;
+            walk_element.type = "Walk"s;
+            walk_element.stop_name = props.stop_from;
+            walk_element.stop_to = props.stop_to;
+            walk_element.distance = props.distance;
+            walk_element.time = props.travel_time;
+            walk_element.span_count = 0;
+            route_stat.items.push_back(std::move(walk_element));
+            total_time += props.travel_time;
+            continue;
+        }
+
         RouteElement wait_element;
         wait_element.stop_name = props.stop_from;
         wait_element.time = routing_settings.bus_wait_time;
@@ -1,11 +1,21 @@
 #pragma once
 
+#include "geo.h"
+#include "graph_components.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
 struct RoutingSettings {
-    int bus_wait_time;
-    double bus_velocity;
+    int bus_wait_time = 0;
+    double bus_velocity = 0.0;
+    // metres per minute, like bus_velocity
+    double walk_velocity = 5000.0 / 60.0;
+    // nearest stops tried at each end of a door-to-door route
+    int walk_stop_candidates = 5;
+    // stops this close (in metres) are linked by walking transfers; 0 turns them off
+    double walk_transfer_distance = 0.0;
+    // GPS lengths of the buses: "cosines" (the default) or "haversine", which is vectorized
+    geo::DistanceFormula distance_formula = geo::DistanceFormula::COSINES;
 };
 
 struct RouteElement {
@@ -14,6 +24,10 @@ struct RouteElement {
     std::string bus_name;
     double time;
     int span_count;
+    // "Walk" items: stop_name is where the walk starts and stop_to where it ends, empty for a door;
+    // distance is rounded to whole metres like the walking transfers
+    std::string stop_to;
+    int distance = 0;
 };
 
 struct RouteStat {
@@ -23,12 +37,14 @@ struct RouteStat {
     double bus_wait_time;
 };
 
+// a walking transfer has no bus; its distance is in whole metres
 struct EdgeProps {
     const Bus* bus;
     int span_count;
     int distance;
     double travel_time;
     std::string_view stop_from;
+    std::string_view stop_to;
 };
 
 using map_pair_distance = std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, EdgeProps, tc::HasherForPair>;
@@ -48,8 +64,10 @@ public:
 
     const EdgeProps& GetEdgeProps(graph::EdgeId) const;
     const RoutingSettings& GetRouterSettings() const;
-    int GetDistanceFromTo(const Stop* prev_stop, const Stop* current_stop, graph::VertexId vid_stop_from, graph::VertexId prev_stop_to);
-    void DistanceToEdge(map_pair_distance pair_distance);
+    void DistanceToEdge(const map_pair_distance& pair_distance);
+    void AddWalkingEdges();
+    // labelled at the end of CreateGraph
+    const graph::Components& GetComponents() const;
     
     
     const RouteStat GetRoute(RoutingSettings routing_settings, std::optional<graph::Router<double>::RouteInfo> route_info, const TransportRouter& transport_router) const;
@@ -59,6 +77,6 @@ private:
     const tc::TransportCatalogue& transport_catalogue_;
     const RoutingSettings& routing_settings_;
     std::unordered_map<graph::EdgeId, EdgeProps> edgeID_n_edge_props_;
-    std::unordered_map<std::pair<graph::VertexId, graph::VertexId>, int, tc::HasherForPair> pair_n_distance_;
+    graph::Components components_;
 };
 
@@ -0,0 +1,181 @@
+#include "versioned_catalogue.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace {
+    template <typename Names>
+    size_t FillCatalogue(tc::TransportCatalogue& catalogue, const RoutingSettings& routing_settings, Names&& names,
+                         std::deque<Stop>&& stops, std::deque<Bus>&& buses,
+                         size_t freeze_threads_count = std::thread::hardware_concurrency()) {
+        catalogue.SetDistanceFormula(routing_settings.distance_formula);
+        catalogue.SetFreezeThreadsCount(freeze_threads_count);
+        catalogue.FillTransportBase(std::move(names), std::move(stops), std::move(buses));
+        return catalogue.GetAllStopsCount();
+    }
+
+    const graph::DirectedWeightedGraph<double>& CreateGraph(TransportRouter& transport_router, const graph::DirectedWeightedGraph<double>& routes_graph) {
+        transport_router.CreateGraph();
+        return routes_graph;
+    }
+}
+
+CatalogueSnapshot::CatalogueSnapshot(StringArena&& names, std::deque<Stop>&& stops, std::deque<Bus>&& buses,
+                                     const RenderSettings& render_settings, const RoutingSettings& routing_settings)
+    : routing_settings_(routing_settings)
+    , routes_graph_(FillCatalogue(catalogue_, routing_settings_, std::move(names), std::move(stops), std::move(buses)))
+    , transport_router_(routes_graph_, catalogue_, routing_settings_)
+    , router_(CreateGraph(transport_router_, routes_graph_))
+    , renderer_(render_settings)
+    , request_handler_(catalogue_, renderer_, router_, transport_router_) {
+}
+
+CatalogueSnapshot::CatalogueSnapshot(std::shared_ptr<SharedStringArena> names, std::deque<Stop>&& stops, std::deque<Bus>&& buses,
+                                     const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                                     size_t freeze_threads_count)
+    : routing_settings_(routing_settings)
+    , routes_graph_(FillCatalogue(catalogue_, routing_settings_, std::move(names), std::move(stops), std::move(buses),
+                                  freeze_threads_count))
+    , transport_router_(routes_graph_, catalogue_, routing_settings_)
+    , router_(CreateGraph(transport_router_, routes_graph_))
+    , renderer_(render_settings)
+    , request_handler_(catalogue_, renderer_, router_, transport_router_) {
+}
+
+CatalogueSnapshot::CatalogueSnapshot(tc::TransportCatalogue&& catalogue, const RenderSettings& render_settings,
+                                     const RoutingSettings& routing_settings)
+    : routing_settings_(routing_settings)
+    , catalogue_(std::move(catalogue))
+    , routes_graph_(catalogue_.GetAllStopsCount())
+    , transport_router_(routes_graph_, catalogue_, routing_settings_)
+    , router_(CreateGraph(transport_router_, routes_graph_))
+    , renderer_(render_settings)
+    , request_handler_(catalogue_, renderer_, router_, transport_router_) {
+}
+
+const tc::TransportCatalogue& CatalogueSnapshot::GetCatalogue() const {
+    return catalogue_;
+}
+
+const RequestHandler& CatalogueSnapshot::GetRequestHandler() const {
+    return request_handler_;
+}
+
+VersionedCatalogue::ReadGuard::ReadGuard(const VersionedCatalogue* owner, std::atomic<uint64_t>* slot,
+                                         const CatalogueSnapshot* snapshot)
+    : owner_(owner)
+    , slot_(slot)
+    , snapshot_(snapshot) {
+}
+
+VersionedCatalogue::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr))
+    , slot_(std::exchange(other.slot_, nullptr))
+    , snapshot_(std::exchange(other.snapshot_, nullptr)) {
+}
+
+VersionedCatalogue::ReadGuard::~ReadGuard() {
+    if (owner_ == nullptr) {
+        return;
+    }
+    // a reader that started before the latest retirement may have been the last to hold a retired
+    // snapshot, so it frees what it can instead of leaving that to the next Publish()
+    const bool may_hold_retired = slot_ != nullptr
+        ? slot_->exchange(0) < owner_->retired_epoch_.load()
+        : owner_->overflow_readers_.fetch_sub(1) == 1 && owner_->retired_epoch_.load() != 0;
+    if (may_hold_retired) {
+        std::lock_guard guard(owner_->writer_mutex_);
+        owner_->ReclaimLocked();
+    }
+}
+
+const CatalogueSnapshot& VersionedCatalogue::ReadGuard::operator*() const {
+    return *snapshot_;
+}
+
+const CatalogueSnapshot* VersionedCatalogue::ReadGuard::operator->() const {
+    return snapshot_;
+}
+
+VersionedCatalogue::ReadGuard::operator bool() const {
+    return snapshot_ != nullptr;
+}
+
+VersionedCatalogue::~VersionedCatalogue() {
+    for (const auto& [epoch, snapshot] : retired_) {
+        delete snapshot;
+    }
+    delete current_.load();
+}
+
+VersionedCatalogue::ReadGuard VersionedCatalogue::Read() const {
+    // threads start probing at different slots so they rarely fight over the same one
+    const size_t start = std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS;
+
+    for (size_t i = 0; i < MAX_READERS; ++i) {
+        std::atomic<uint64_t>& slot = readers_[(start + i) % MAX_READERS].epoch;
+        uint64_t expected = 0;
+        // the epoch is published before the snapshot pointer is loaded; a stale (smaller) epoch
+        // only makes the writer more conservative
+        if (slot.load() == 0 && slot.compare_exchange_strong(expected, epoch_.load())) {
+            return ReadGuard(this, &slot, current_.load());
+        }
+    }
+
+    // every slot is taken: counted before the snapshot pointer is loaded, for the same reason
+    overflow_readers_.fetch_add(1);
+    return ReadGuard(this, nullptr, current_.load());
+}
+
+uint64_t VersionedCatalogue::Publish(std::unique_ptr<const CatalogueSnapshot> snapshot) {
+    std::lock_guard guard(writer_mutex_);
+
+    const CatalogueSnapshot* old_snapshot = current_.exchange(snapshot.release());
+    // readers that start from now on record at least retire_epoch and can only see the new snapshot
+    const uint64_t retire_epoch = epoch_.fetch_add(1) + 1;
+    if (old_snapshot != nullptr) {
+        retired_.emplace_back(retire_epoch, old_snapshot);
+        retired_epoch_.store(retire_epoch);
+    }
+
+    ReclaimLocked();
+    return retire_epoch - 1;
+}
+
+void VersionedCatalogue::Reclaim() {
+    std::lock_guard guard(writer_mutex_);
+    ReclaimLocked();
+}
+
+void VersionedCatalogue::ReclaimLocked() const {
+    // an overflow reader may hold any snapshot retired since it started
+    if (overflow_readers_.load() != 0) {
+        return;
+    }
+
+    uint64_t oldest_reader = std::numeric_limits<uint64_t>::max();
+    for (const ReaderSlot& reader : readers_) {
+        if (const uint64_t epoch = reader.epoch.load(); epoch != 0) {
+            oldest_reader = std::min(oldest_reader, epoch);
+        }
+    }
+
+    auto still_visible = std::partition(retired_.begin(), retired_.end(), [oldest_reader](const auto& retired) {
+        return retired.first > oldest_reader;
+    });
+    for (auto it = still_visible; it != retired_.end(); ++it) {
+        delete it->second;
+    }
+    retired_.erase(still_visible, retired_.end());
+}
+
+uint64_t VersionedCatalogue::GetVersion() const {
+    return epoch_.load() - 1;
+}
+
+size_t VersionedCatalogue::GetRetiredCount() const {
+    std::lock_guard guard(writer_mutex_);
+    return retired_.size();
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "graph.h"
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "router.h"
+#include "string_arena.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Everything a stat request needs, built once and never modified afterwards.
+// The members reference each other, so a snapshot is neither copied nor moved.
+class CatalogueSnapshot {
+public:
+    CatalogueSnapshot(StringArena&& names, std::deque<Stop>&& stops, std::deque<Bus>&& buses,
+                      const RenderSettings& render_settings, const RoutingSettings& routing_settings);
+    // names interned into an arena shared with other snapshots; the catalogue is frozen on at most
+    // freeze_threads_count threads
+    CatalogueSnapshot(std::shared_ptr<SharedStringArena> names, std::deque<Stop>&& stops, std::deque<Bus>&& buses,
+                      const RenderSettings& render_settings, const RoutingSettings& routing_settings,
+                      size_t freeze_threads_count = std::thread::hardware_concurrency());
+    // a catalogue already filled and frozen with the distance formula of routing_settings
+    CatalogueSnapshot(tc::TransportCatalogue&& catalogue, const RenderSettings& render_settings, const RoutingSettings& routing_settings);
+
+    CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+    CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+    const tc::TransportCatalogue& GetCatalogue() const;
+    const RequestHandler& GetRequestHandler() const;
+
+private:
+    RoutingSettings routing_settings_;
+    tc::TransportCatalogue catalogue_;
+    graph::DirectedWeightedGraph<double> routes_graph_;
+    TransportRouter transport_router_;
+    graph::Router<double> router_;
+    MapRenderer renderer_;
+    RequestHandler request_handler_;
+};
+
+// Serves snapshots to concurrent readers while a writer publishes new ones.
+// Readers never lock or wait: Read() claims one of MAX_READERS slots with a CAS and records the epoch
+// it started in; with every slot taken it joins an overflow count instead, which holds back all
+// reclaiming until it drops to zero.
+// A replaced snapshot is retired with the epoch of its replacement and deleted once every reader
+// that could still hold it is gone: the last such reader to release its guard deletes it.
+class VersionedCatalogue {
+public:
+    static constexpr size_t MAX_READERS = 64;
+
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard();
+
+        const CatalogueSnapshot& operator*() const;
+        const CatalogueSnapshot* operator->() const;
+        explicit operator bool() const;
+
+    private:
+        friend class VersionedCatalogue;
+        // slot is null for an overflow reader
+        ReadGuard(const VersionedCatalogue* owner, std::atomic<uint64_t>* slot, const CatalogueSnapshot* snapshot);
+
+        const VersionedCatalogue* owner_;
+        std::atomic<uint64_t>* slot_;
+        const CatalogueSnapshot* snapshot_;
+    };
+
+    VersionedCatalogue() = default;
+    VersionedCatalogue(const VersionedCatalogue&) = delete;
+    VersionedCatalogue& operator=(const VersionedCatalogue&) = delete;
+    // no reader may be active when the catalogue is destroyed
+    ~VersionedCatalogue();
+
+    // pins the current snapshot until the guard is destroyed; empty guard before the first Publish()
+    ReadGuard Read() const;
+    // makes the snapshot visible to new readers; returns its version
+    uint64_t Publish(std::unique_ptr<const CatalogueSnapshot> snapshot);
+    // frees retired snapshots no reader can see any more; Publish() calls it too
+    void Reclaim();
+
+    uint64_t GetVersion() const;
+    size_t GetRetiredCount() const;
+
+private:
+    struct alignas(64) ReaderSlot {
+        // 0 when free, otherwise the epoch the reader started in
+        std::atomic<uint64_t> epoch{0};
+    };
+
+    void ReclaimLocked() const;
+
+    mutable std::array<ReaderSlot, MAX_READERS> readers_;
+    std::atomic<const CatalogueSnapshot*> current_{nullptr};
+    mutable std::atomic<size_t> overflow_readers_{0};
+    std::atomic<uint64_t> epoch_{1};
+    // epoch of the latest retirement: readers that started before it may hold a retired snapshot
+    std::atomic<uint64_t> retired_epoch_{0};
+
+    mutable std::mutex writer_mutex_;
+    mutable std::vector<std::pair<uint64_t, const CatalogueSnapshot*>> retired_;
+};